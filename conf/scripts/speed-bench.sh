@@ -0,0 +1,186 @@
+#!/bin/bash
+
+# Simulator throughput benchmark. Runs the shipped benchmarks under every
+# (simu.conf, mode) pair and writes one line per run with the host speed
+# (KIPS), the startup time (wall time not spent in TaskHandler::boot) and
+# the peak RSS. Given a baseline file from an earlier run, it prints the
+# KIPS ratio per run and exits with 1 if any run is slower than
+# SPEEDBENCH_TOLERANCE.
+#
+# use: speed-bench.sh [results.tsv] [baseline.tsv]
+#
+# make speedbench in the build directory runs it on that build, the
+# baseline can be passed with SPEEDBENCH_BASELINE.
+
+# Defaults for configuration variables used by script
+: ${ESESC_SRC:=${HOME}/projs/esesc}
+: ${ESESC_BUILD_DIR:=${HOME}/build}
+: ${ESESC_BUILD_TYPE:=Debug}
+: ${ESESC_TARGET:=riscv64}
+: ${SPEEDBENCH_CONFS:="simu.conf simu.conf.boom3 simu.conf.zen2 simu.conf.ldbp"}
+: ${SPEEDBENCH_MODES:="rabbit warmup timing"}
+: ${SPEEDBENCH_NINST:=2e7}
+: ${SPEEDBENCH_TOLERANCE:=0.05}
+: ${SPEEDBENCH_RUN_DIR:=${ESESC_BUILD_DIR}/${ESESC_BUILD_TYPE,,}/speedbench}
+: ${SPEEDBENCH_ESESC:=${ESESC_BUILD_DIR}/${ESESC_BUILD_TYPE,,}/main/esesc}
+
+RESULTS=${1:-speedbench.tsv}
+BASELINE=${2:-${SPEEDBENCH_BASELINE}}
+
+if [ ! -e ${ESESC_SRC}/CMakeLists.txt ]; then
+  echo "ERROR: '${ESESC_SRC}' does not contain ESESC source code"
+  exit -1
+fi
+
+if [ ! -x ${SPEEDBENCH_ESESC} ]; then
+  echo "ERROR: '${SPEEDBENCH_ESESC}' is not an ESESC binary"
+  exit -2
+fi
+
+# GNU time gives the peak RSS, without it only the wall time is measured
+TIMECMD=/usr/bin/time
+if [ ! -x ${TIMECMD} ]; then
+  echo "WARNING: ${TIMECMD} not found, peakRSSKB will be 0"
+  TIMECMD=
+fi
+
+# Benchmarks as "name|binary args|stdin file". SPEEDBENCH_BENCHS overrides
+# the defaults (one entry per line). The defaults are the binaries shipped
+# for ESESC_TARGET plus the kernels, when they were built for it.
+if [ -z "${SPEEDBENCH_BENCHS}" ]; then
+  BDIR=${ESESC_SRC}/bins/${ESESC_TARGET}
+  KDIR=${ESESC_SRC}/bins/kernels
+  SPEEDBENCH_BENCHS="smatrix|${BDIR}/smatrix.${ESESC_TARGET}
+crafty|${BDIR}/spec00_crafty.${ESESC_TARGET}|${ESESC_SRC}/bins/inputs/crafty.in
+hanoi|${KDIR}/hanoi/hanoi.${ESESC_TARGET} 16 20
+kmp|${KDIR}/kmp/kmp.${ESESC_TARGET} ref
+dhry|${KDIR}/dhry/dhry.${ESESC_TARGET} 100"
+fi
+
+RESULTS=$(readlink -f ${RESULTS})
+mkdir -p ${SPEEDBENCH_RUN_DIR}
+cd ${SPEEDBENCH_RUN_DIR}
+cp ${ESESC_SRC}/conf/*conf* .
+
+# One sampler section per mode, all the instructions in that mode
+for mode in ${SPEEDBENCH_MODES}; do
+  case ${mode} in
+    rabbit) nRabbit=${SPEEDBENCH_NINST}; nWarmup=0; nTiming=0 ;;
+    warmup) nRabbit=0; nWarmup=${SPEEDBENCH_NINST}; nTiming=0 ;;
+    timing) nRabbit=0; nWarmup=0; nTiming=${SPEEDBENCH_NINST} ;;
+    *)
+      echo "ERROR: unknown mode '${mode}' (rabbit, warmup or timing)"
+      exit -4
+      ;;
+  esac
+  cat > speedbench.${mode}.conf <<EOF
+
+[speedbench_${mode}]
+type              = "inst"
+nInstSkip         = 1
+nInstSkipThreads  = 1
+maxnsTime         = 1e12 # required
+nInstMax          = ${SPEEDBENCH_NINST}
+nInstRabbit       = ${nRabbit}
+nInstWarmup       = ${nWarmup}
+nInstDetail       = 0
+nInstTiming       = ${nTiming}
+PowPredictionHist = 5
+doPowPrediction   = 1
+ROIOnly           = false
+EOF
+done
+
+# Report field, 0 if missing
+field() {
+  awk -F= -v k="$2" '$1 == k && v == "" { split($2, a, ":"); v = a[1] } END { printf "%d", v }' $1
+}
+
+printf "bench\tconf\tmode\tinsts\twallSecs\tstartupSecs\tKIPS\tpeakRSSKB\tstatus\n" > ${RESULTS}
+
+echo "${SPEEDBENCH_BENCHS}" | while IFS='|' read name cmd input; do
+  [ -z "${name}" ] && continue
+  bin=${cmd%% *}
+  if [ ! -e ${bin} ]; then
+    echo "WARNING: skipping ${name}, '${bin}' not found"
+    continue
+  fi
+  input=${input:-/dev/null}
+
+  for conf in ${SPEEDBENCH_CONFS}; do
+    if [ ! -e ${conf} ]; then
+      echo "WARNING: skipping ${conf}, not in ${ESESC_SRC}/conf"
+      continue
+    fi
+    for mode in ${SPEEDBENCH_MODES}; do
+      tag=${name}.${conf#simu.conf}.${mode}
+      tag=${tag/../.}
+
+      # esesc.conf with the core configuration swapped and the mode sampler
+      sed -e "s/^<simu\.conf[^>]*>/<${conf}>/" esesc.conf > esesc.${tag}.conf
+      cat speedbench.${mode}.conf >> esesc.${tag}.conf
+
+      rm -f esesc_speedbench_${tag}.*
+      start=$(date +%s.%N)
+      ESESCCONF=esesc.${tag}.conf \
+      ESESC_samplerSel=speedbench_${mode} \
+      ESESC_benchName="${cmd}" \
+      ESESC_reportFile=speedbench_${tag} \
+        ${TIMECMD:+${TIMECMD} -f "%e %M" -o time.${tag}} \
+        ${SPEEDBENCH_ESESC} > log.${tag} 2>&1 < ${input}
+      status=$?
+
+      if [ -n "${TIMECMD}" ]; then
+        read wall rss < time.${tag}
+      else
+        wall=$(echo "${start} $(date +%s.%N)" | awk '{ printf "%.2f", $2 - $1 }')
+        rss=0
+      fi
+      report=$(ls -t esesc_speedbench_${tag}.* 2>/dev/null | head -1)
+      insts=0
+      msecs=0
+      if [ -n "${report}" ]; then
+        for m in Rabbit Warmup Detail Timing; do
+          insts=$((insts + $(field ${report} "S(0):${m}Inst")))
+        done
+        msecs=$(grep "^OSSim:msecs=" ${report} | head -1 | sed 's/^[^=]*=//')
+      fi
+
+      awk -v b="${name}" -v c="${conf}" -v m="${mode}" -v i="${insts}" -v w="${wall}" -v s="${msecs:-0}" -v r="${rss}" -v st="${status}" 'BEGIN {
+        startup = w - s;
+        if(startup < 0)
+          startup = 0;
+        kips = s > 0 ? i / s / 1000 : 0;
+        printf "%s\t%s\t%s\t%d\t%.2f\t%.2f\t%.1f\t%d\t%d\n", b, c, m, i, w, startup, kips, r, st;
+      }' | tee -a ${RESULTS}
+    done
+  done
+done
+
+# A benchmark list that simulates nothing must not pass as "not slower"
+nRun=$(awk -F'\t' 'NR > 1 && $4 > 0 && $9 == 0' ${RESULTS} | wc -l)
+if [ ${nRun} -eq 0 ]; then
+  echo "ERROR: no benchmark ran for ${ESESC_TARGET} (see SPEEDBENCH_BENCHS)"
+  exit -5
+fi
+
+[ -z "${BASELINE}" ] && exit 0
+
+# Compare against the baseline by (bench, conf, mode)
+awk -F'\t' -v tol=${SPEEDBENCH_TOLERANCE} '
+  FNR == 1 { next }
+  NR == FNR { base[$1 FS $2 FS $3] = $7; next }
+  {
+    key = $1 FS $2 FS $3;
+    if(!(key in base) || base[key] <= 0)
+      next;
+    ratio = $7 / base[key];
+    flag  = "";
+    if(ratio < 1 - tol) {
+      flag = " SLOWER";
+      nSlow++;
+    }
+    printf "%-12s %-18s %-7s %10.1f KIPS (baseline %10.1f) x%.3f%s\n", $1, $2, $3, $7, base[key], ratio, flag;
+  }
+  END { exit nSlow > 0 ? 1 : 0 }
+' ${BASELINE} ${RESULTS}
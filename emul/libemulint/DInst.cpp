@@ -38,7 +38,7 @@
 #include "EmulInterface.h"
 /* }}} */
 
-pool<DInst> DInst::dInstPool(32768, "DInst"); // 4 * tsfifo size
+tsbatchpool<DInst> DInst::dInstPool(32768, "DInst"); // 4 * tsfifo size
 
 Time_t DInst::currentID = 0;
 
@@ -242,10 +242,37 @@ DInst *DInst::clone() {
   return i;
 }
 
+DInst *DInst::unpinForReplay(bool &copied) {
+  I(replayPinned);
+
+  replayPinned = false;
+
+  if(!replayReleased) {
+    // Still in the pipeline, the copy is re-executed and this one is returned
+    // to the pool by the pipeline as usual.
+    copied = true;
+    return clone();
+  }
+
+  // The pipeline already released it, reuse the same object in place
+  copied = false;
+#ifdef ESESC_TRACE_DATA
+  chained = 0;
+#endif
+  setup();
+
+  return this;
+}
+
 void DInst::recycle() {
   I(nDeps == 0); // No deps src
   I(first == 0); // no dependent instructions
 
+  if(replayPinned) {
+    replayReleased = true;
+    return;
+  }
+
   dInstPool.in(this);
 }
 
@@ -256,6 +283,11 @@ void DInst::scrap(EmulInterface *eint) {
   I(eint);
   eint->reexecuteTail(fid);
 
+  if(replayPinned) {
+    replayReleased = true; // The EmuDInstQueue still owns it
+    return;
+  }
+
   dInstPool.in(this);
 }
 
@@ -270,5 +302,10 @@ void DInst::destroy(EmulInterface *eint) {
   I(eint);
   eint->reexecuteTail(fid);
 
+  if(replayPinned) {
+    replayReleased = true; // The EmuDInstQueue still owns it
+    return;
+  }
+
   dInstPool.in(this);
 }
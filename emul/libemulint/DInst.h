@@ -154,7 +154,7 @@ private:
   // In a typical RISC processor MAX_PENDING_SOURCES should be 2
   static const int32_t MAX_PENDING_SOURCES = 3;
 
-  static pool<DInst> dInstPool;
+  static tsbatchpool<DInst> dInstPool;
 
   DInstNext  pend[MAX_PENDING_SOURCES];
   DInstNext *last;
@@ -195,6 +195,8 @@ private:
   bool interCluster;
   bool keepStats;
   bool biasBranch;
+  bool replayPinned;   // still referenced by the EmuDInstQueue after a flush
+  bool replayReleased; // the pipeline is done with a pinned instruction
   uint32_t branch_signature;
   bool imli_highconf;
 
@@ -247,6 +249,10 @@ private:
 #endif
   void setup() {
     ID = currentID++;
+    clearState();
+  }
+
+  void clearState() {
 #ifdef DEBUG
     mreq_id = 0;
 #endif
@@ -295,6 +301,8 @@ private:
     dispatched   = false;
     fullMiss     = false;
 
+    replayPinned   = false;
+    replayReleased = false;
 
 #ifdef DINST_PARENT
     pend[0].setParentDInst(0);
@@ -313,6 +321,14 @@ public:
 
   DInst *clone();
 
+  void pinForReplay() {
+    replayPinned = true;
+  }
+  bool isReplayPinned() const {
+    return replayPinned;
+  }
+  DInst *unpinForReplay(bool &copied);
+
   bool getStatsFlag() const {
     return keepStats;
   }
@@ -320,39 +336,59 @@ public:
   static DInst *create(const Instruction *inst, AddrType pc, AddrType address, FlowID fid, bool keepStats) {
     DInst *i = dInstPool.out();
 
-    I(inst);
+    i->init(inst, pc, address, fid, keepStats);
+    i->setup();
 
-    i->fid  = fid;
-    i->inst = *inst;
-    i->pc   = pc;
-    i->addr = address;
-    i->inflight = 0;
+    return i;
+  }
+
+  // Called by the emulation (producer) thread. The DInst gets its ID with
+  // assignID when the simulation thread takes it.
+  static DInst *createRemote(const Instruction *inst, AddrType pc, AddrType address, FlowID fid, bool keepStats) {
+    DInst *i = dInstPool.outRemote();
+
+    i->init(inst, pc, address, fid, keepStats);
+    i->clearState();
+
+    return i;
+  }
+
+  void assignID() {
+    ID = currentID++;
+  }
+
+  void init(const Instruction *inst_, AddrType pc_, AddrType address, FlowID fid_, bool keepStats_) {
+    I(inst_);
+
+    fid  = fid_;
+    inst = *inst_;
+    pc   = pc_;
+    addr = address;
+    inflight = 0;
 #ifdef ESESC_TRACE_DATA
-    i->data      = 0;
-    i->data2     = 0;
-    i->br_data1  = 0;
-    i->br_data2  = 0;
-    i->ld_br_type = 0;
-    i->dep_depth = 0;
-    i->ldpc      = 0;
-    i->ld_addr   = 0;
-    i->base_pref_addr   = 0;
-    i->data_sign = DS_NoData;
-    i->chained   = 0;
+    data      = 0;
+    data2     = 0;
+    br_data1  = 0;
+    br_data2  = 0;
+    ld_br_type = 0;
+    dep_depth = 0;
+    ldpc      = 0;
+    ld_addr   = 0;
+    base_pref_addr   = 0;
+    data_sign = DS_NoData;
+    chained   = 0;
     //BR stats
-    i->brpc = 0;
-    i->delta = 0;
-    i->br_ld_chain = false;
-    i->br_op_type = -1;
+    brpc = 0;
+    delta = 0;
+    br_ld_chain = false;
+    br_op_type = -1;
 #endif
-    i->fetched   = 0;
-    i->keepStats = keepStats;
-
-    i->setup();
-    I(i->getInst()->getOpcode());
+    fetched   = 0;
+    keepStats = keepStats_;
 
-    return i;
+    I(getInst()->getOpcode());
   }
+
 #ifdef ESESC_TRACE_DATA
   uint64_t getDelta() const{
     return delta;
@@ -451,6 +487,11 @@ public:
   // DataSign getDataSign() const { return data_sign; }
   void setDataSign(int64_t _data, AddrType ldpc);
   void addDataSign(int ds, int64_t _data, AddrType ldpc);
+  void clearDataSign() { // Same as a new DInst (no load feeds it)
+    data      = 0;
+    ldpc      = 0;
+    data_sign = DS_NoData;
+  }
 
   void setBrData1(DataType _data) {
     br_data1 = _data;
@@ -493,6 +534,7 @@ public:
   }
   void setDataSign(int64_t _data, AddrType ldpc){};
   void addDataSign(int ds, int64_t _data, AddrType ldpc){};
+  void clearDataSign(){};
   void setData(uint64_t _data) {
   }
   AddrType getLDPC() const {
@@ -845,11 +887,9 @@ public:
     last       = n;
   }
 
-#if 0
   void setAddr(AddrType a) {
     addr = a;
   }
-#endif
   void setPC(AddrType a) {
     pc = a;
   }
@@ -53,9 +53,19 @@ EmuDInstQueue::EmuDInstQueue() {
   ndrop       = 0;
   trace.resize(1024);
 
+  nFlush       = 0;
+  nFlushInsts  = 0;
+  nFlushCopies = 0;
+
   I(ISPOWER2(trace.size()));
 }
 
+void EmuDInstQueue::setStats(FlowID fid) {
+  nFlush       = new GStatsCntr("EmuDInstQueue(%d):nFlush", fid);
+  nFlushInsts  = new GStatsCntr("EmuDInstQueue(%d):nFlushInsts", fid);
+  nFlushCopies = new GStatsCntr("EmuDInstQueue(%d):nFlushCopies", fid);
+}
+
 void EmuDInstQueue::adjust_trace() {
 
   // T...H...I
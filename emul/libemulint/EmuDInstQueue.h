@@ -38,6 +38,7 @@
 #include <vector>
 
 #include "DInst.h"
+#include "GStats.h"
 #include "nanassert.h"
 
 class EmuDInstQueue {
@@ -50,12 +51,18 @@ private:
 
   std::vector<DInst *> trace;
 
+  GStatsCntr *nFlush;       // moveHead2Tail calls with something to rewind
+  GStatsCntr *nFlushInsts;  // instructions rewound
+  GStatsCntr *nFlushCopies; // rewound instructions still in the pipeline when re-executed
+
 protected:
   void adjust_trace();
 
 public:
   EmuDInstQueue();
 
+  void setStats(FlowID fid);
+
   void popHead() {
     I(!empty());
 
@@ -65,7 +72,16 @@ public:
   DInst *getHead() {
     I(!empty());
 
-    return trace[head];
+    DInst *dinst = trace[head];
+    if(unlikely(dinst->isReplayPinned())) {
+      bool copied;
+      dinst       = dinst->unpinForReplay(copied);
+      trace[head] = dinst;
+      if(copied && nFlushCopies)
+        nFlushCopies->inc();
+    }
+
+    return dinst;
   };
 
   DInst *getTail() {
@@ -109,14 +125,23 @@ public:
   }
 
   void moveHead2Tail() {
+    // Rewind without copying. The flushed instructions stay in the ring
+    // pinned; getHead reuses (or copies, if still in the pipeline) them.
     uint32_t tail_copy = tail;
+    uint32_t n         = 0;
     while(head != tail) {
-      trace[tail] = trace[tail]->clone();
-      tail        = (tail + 1) & (trace.size() - 1);
-      ndrop++;
+      trace[tail]->pinForReplay();
+      tail = (tail + 1) & (trace.size() - 1);
+      n++;
     }
+    ndrop += n;
     head = tail_copy;
     tail = tail_copy;
+
+    if(n && nFlush) {
+      nFlush->inc();
+      nFlushInsts->add(n);
+    }
   }
 
   uint32_t size() const {
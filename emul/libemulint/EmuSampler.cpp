@@ -52,6 +52,8 @@ uint64_t *        EmuSampler::clockPrev;
 uint64_t *        EmuSampler::fticksPrev;
 
 float EmuSampler::turboRatio = 1.0;
+
+bool EmuSampler::forkSampling = false;
 extern long long int icount;
 
 EmuSampler::EmuSampler(const char *iname, EmulInterface *emu, FlowID fid)
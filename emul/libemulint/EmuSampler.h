@@ -121,6 +121,8 @@ protected:
 
   static float turboRatio;
 
+  static bool forkSampling; // Samples run in forked children (forkSamples)
+
 public:
   uint64_t totalnInst; // total # instructions
   EmuMode  getMode() const {
@@ -140,6 +142,9 @@ public:
   static bool isTerminated() {
     return terminated;
   }
+  static bool isForkSampling() {
+    return forkSampling;
+  }
 
   bool getrestartrabbitstatus() {
     return restartRabbit;
@@ -38,7 +38,7 @@
 #include "SescConf.h"
 #include "ThreadSafeFIFO.h"
 
-ThreadSafeFIFO<RAWDInst> *Reader::tsfifo                   = NULL;
+ThreadSafeFIFO<DInst *> *Reader::tsfifo                   = NULL;
 pthread_mutex_t *         Reader::tsfifo_snd_mutex         = NULL;
 volatile int *            Reader::tsfifo_snd_mutex_blocked = 0;
 pthread_mutex_t           Reader::tsfifo_rcv_mutex;
@@ -53,7 +53,7 @@ Reader::Reader(const char *section) {
 
     nemul = SescConf->getRecordSize("", "cpuemul");
 
-    tsfifo = new ThreadSafeFIFO<RAWDInst>[nemul];
+    tsfifo = new ThreadSafeFIFO<DInst *>[nemul];
 
     // On thread for each tsfifo sender
     tsfifo_snd_mutex         = new pthread_mutex_t[nemul];
@@ -70,5 +70,7 @@ Reader::Reader(const char *section) {
     pthread_mutex_lock(&tsfifo_rcv_mutex);
 
     ruffer = new EmuDInstQueue[nemul];
+    for(FlowID i = 0; i < nemul; i++)
+      ruffer[i].setStats(i);
   }
 }
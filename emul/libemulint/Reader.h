@@ -48,7 +48,7 @@ class Reader {
 private:
 protected:
   static FlowID                    nemul;
-  static ThreadSafeFIFO<RAWDInst> *tsfifo;
+  static ThreadSafeFIFO<DInst *> *tsfifo;
   static pthread_mutex_t *         tsfifo_snd_mutex;
   static volatile int *            tsfifo_snd_mutex_blocked;
   static pthread_mutex_t           tsfifo_rcv_mutex;
@@ -36,6 +36,7 @@
 #endif
 
 #include "EmuSampler.h"
+#include "HostProfiler.h"
 #include "QEMUReader.h"
 #include "SescConf.h"
 //#include "SPARCInstruction.h"
@@ -48,6 +49,14 @@
 
 pthread_mutex_t mutex_ctrl;
 
+static void lockCtrlForFork() {
+  pthread_mutex_lock(&mutex_ctrl);
+}
+
+static void unlockCtrlAfterFork() {
+  pthread_mutex_unlock(&mutex_ctrl);
+}
+
 #if 0
 void *QEMUReader::getSharedMemory(size_t size)
 /* Allocate a shared memory region {{{1 */
@@ -98,6 +107,9 @@ void QEMUReader::start()
     return;
 
   pthread_mutex_init(&mutex_ctrl, 0);
+  // Forked samples (SamplerBase::forkSample) must not copy the mutex taken
+  if(EmuSampler::isForkSampling())
+    pthread_atfork(lockCtrlForFork, unlockCtrlAfterFork, unlockCtrlAfterFork);
 
   started = true;
 
@@ -153,7 +165,10 @@ void QEMUReader::queueInstruction(AddrType pc, AddrType addr, DataType data, Flo
   I(dest < LREG_MAX);
   I(dest2 < LREG_MAX);
 
-  while(tsfifo[fid].full()) {
+  if(tsfifo[fid].fullLocal())
+    tsfifo[fid].publish(); // The consumer must see everything before we block
+
+  while(tsfifo[fid].fullLocal()) {
     if(qsamplerlist[fid]->isActive(fid) == false) {
       qsamplerlist[fid]->resumeThread(fid, fid);
     }
@@ -183,29 +198,31 @@ void QEMUReader::queueInstruction(AddrType pc, AddrType addr, DataType data, Flo
     // MSG("2.wakeup snd%d",fid);
   }
 
-  RAWDInst *rinst = tsfifo[fid].getTailRef();
-
-  I(rinst);
+  // The DInst is built here (QEMU thread), the simulation thread only takes
+  // the pointer in populate
+  Instruction inst;
+  inst.set(static_cast<InstOpcode>(op), static_cast<RegType>(src1), static_cast<RegType>(src2), static_cast<RegType>(dest),
+           static_cast<RegType>(dest2));
 
-  rinst->set(pc, addr, static_cast<InstOpcode>(op), static_cast<RegType>(src1), static_cast<RegType>(src2),
-             static_cast<RegType>(dest), static_cast<RegType>(dest2), keepStats);
+  DInst *dinst = DInst::createRemote(&inst, pc, addr, fid, keepStats);
 #ifdef ESESC_TRACE_DATA
-  rinst->setData(data);
-  rinst->setData2(data2);
+  dinst->setData(data);
+  dinst->setData2(data2);
 #endif
 
-  tsfifo[fid].push();
+  *tsfifo[fid].getLocalTailRef() = dinst;
+  tsfifo[fid].pushLocal();
 }
 /* }}} */
 
 void QEMUReader::syscall(uint32_t num, Time_t time, FlowID fid)
 /* Create an syscall instruction and inject in the pipeline {{{1 */
 {
-  RAWDInst *rinst = tsfifo[fid].getTailRef();
-
-  rinst->set(0xdeaddead, 0, iRALU, LREG_R0, LREG_R0, LREG_InvalidOutput, LREG_InvalidOutput, true);
+  Instruction inst;
+  inst.set(iRALU, LREG_R0, LREG_R0, LREG_InvalidOutput, LREG_InvalidOutput);
 
-  tsfifo[fid].push();
+  *tsfifo[fid].getLocalTailRef() = DInst::createRemote(&inst, 0xdeaddead, 0, fid, true);
+  tsfifo[fid].pushLocal();
 }
 // }}}
 
@@ -223,6 +240,8 @@ bool QEMUReader::populate(FlowID fid) {
   if(ruffer[fid].size() > 1024) // No need to overpopulate the queues
     return true;
 
+  HostProfScope prof(HostProfiler::Populate);
+
   if(!tsfifo[fid].halfFull()) {
     pthread_mutex_lock(&mutex_ctrl); // BEGIN
 
@@ -278,22 +297,12 @@ bool QEMUReader::populate(FlowID fid) {
 
   I(tsfifo[fid].halfFull());
 
+  // The DInsts come fully built from the producer, just take the pointers
   for(int i = 32; i < tsfifo[fid].size(); i++) {
-    RAWDInst *rinst  = tsfifo[fid].getHeadRef();
-    DInst **  dinsth = ruffer[fid].getInsertPointRef();
-
-    *dinsth = DInst::create(rinst->getInst(), rinst->getPC(), rinst->getAddr(), fid, rinst->getStatsFlag());
-#ifdef ESESC_TRACE_DATA
-    (*dinsth)->setData(rinst->getData());
-    (*dinsth)->setData2(rinst->getData2());
-#if 0
-    if (rinst->getPC()==0x142cc) {
-      MSG("pc=142cc ID=%d d1=%d d2=%d d1=%d d2=%d\n",(int)(*dinsth)->getID(), (int)rinst->getData(), (int)rinst->getData2(), (int)(*dinsth)->getData(), (int)(*dinsth)->getData2());
-    }
-#endif
-#endif
+    DInst *dinst = *tsfifo[fid].getHeadRef();
+    dinst->assignID();
 
-    ruffer[fid].add();
+    ruffer[fid].add(dinst);
     tsfifo[fid].pop();
   }
 
@@ -0,0 +1,188 @@
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include <string>
+#include <vector>
+
+#include "BPred.h"
+#include "BPredTrace.h"
+#include "Report.h"
+#include "SescConf.h"
+
+// Trace driven branch predictor evaluation. Every predictor section listed in
+// [bpredbench] configs runs over the same trace (see BPredTrace.h, written by
+// esesc when the bpred section has traceFile). Configurations are independent,
+// so they are spread over nThreads worker threads.
+//
+// use: bpredbench -c bpredbench.conf
+
+class BenchConfig {
+public:
+  const char *section;
+  BPred *     pred;
+
+  DInst *dinst[iBALU_RET + 1][2]; // [opcode][useLevel3], reused per record
+
+  uint64_t nBranches;
+  uint64_t nMiss;
+  uint64_t nNoPredict;
+  double   secs;
+};
+
+static std::vector<BPredTraceRecord> trace;
+static uint64_t                      traceInsts;
+
+static std::vector<BenchConfig> configs;
+static volatile int32_t         nextConfig = 0;
+
+static DInst *createDInst(InstOpcode op, bool useLevel3) {
+  Instruction inst;
+  inst.set(op, LREG_R0, LREG_R0, LREG_InvalidOutput, LREG_InvalidOutput);
+
+  DInst *dinst = DInst::create(&inst, 0, 0, 0, true);
+  if(useLevel3)
+    dinst->setUseLevel3();
+
+  return dinst;
+}
+
+static void runConfig(BenchConfig &cfg) {
+  timeval stTime;
+  gettimeofday(&stTime, 0);
+
+  for(size_t i = 0; i < trace.size(); i++) {
+    const BPredTraceRecord &r = trace[i];
+
+    DInst *dinst = cfg.dinst[r.opcode][(r.flags & BPredTraceRecord::TraceUseLevel3) ? 1 : 0];
+    dinst->setPC(r.pc);
+    dinst->setAddr(r.target);
+    if(r.flags & BPredTraceRecord::TraceLdData) {
+      dinst->setData(r.ldData);
+      dinst->setDataSign(r.ldData, r.ldPC);
+    } else {
+      dinst->clearDataSign(); // Not the previous record's load
+    }
+
+    cfg.pred->fetchBoundaryBegin(dinst);
+    PredType p = cfg.pred->doPredict(dinst);
+    cfg.pred->fetchBoundaryEnd();
+
+    if(p == NoPrediction) {
+      cfg.nNoPredict++;
+      continue;
+    }
+    cfg.nBranches++;
+    if(p == MissPrediction)
+      cfg.nMiss++;
+  }
+
+  timeval endTime;
+  gettimeofday(&endTime, 0);
+  cfg.secs = (endTime.tv_sec - stTime.tv_sec) + (endTime.tv_usec - stTime.tv_usec) / 1e6;
+}
+
+static void *worker(void *) {
+  GStats::attachThread();
+
+  while(true) {
+    int32_t n = AtomicAdd(&nextConfig, 1);
+    if(n >= (int32_t)configs.size())
+      break;
+    runConfig(configs[n]);
+  }
+
+  return 0;
+}
+
+// Split "a b c" conf strings
+static std::vector<std::string> splitList(const char *str) {
+  std::vector<std::string> list;
+  std::string              cur;
+  for(const char *c = str; *c; c++) {
+    if(*c == ' ' || *c == '\t' || *c == ',') {
+      if(!cur.empty())
+        list.push_back(cur);
+      cur.clear();
+    } else {
+      cur += *c;
+    }
+  }
+  if(!cur.empty())
+    list.push_back(cur);
+  return list;
+}
+
+int32_t main(int32_t argc, char **argv, char **envp) {
+  if(argc < 2) {
+    fprintf(stderr, "Usage:\n\t%s -c <bpredbench.conf>\n", argv[0]);
+    exit(0);
+  }
+
+  Report::openFile("bpredbench.log");
+  SescConf = new SConfig(argc, (const char **)argv);
+
+  const char *sec = "bpredbench";
+
+  const char *traceFile = SescConf->getCharPtr(sec, "trace");
+  int32_t     nThreads  = SescConf->getInt(sec, "nThreads");
+  SescConf->isBetween(sec, "nThreads", 1, GStats::MaxShards - 1);
+
+  std::vector<std::string> sections = splitList(SescConf->getCharPtr(sec, "configs"));
+
+  // The predictors and DInsts are created here, the workers only predict
+  configs.reserve(sections.size());
+  for(size_t i = 0; i < sections.size(); i++) {
+    // LDBP needs the DL1 and the load/branch chains, not in the trace
+    const char *type = SescConf->getCharPtr(sections[i].c_str(), "type");
+    if(strcasecmp(type, "ldbp") == 0) {
+      MSG("WARNING: bpredbench skipping [%s], ldbp predictors need a memory hierarchy", sections[i].c_str());
+      continue;
+    }
+
+    configs.push_back(BenchConfig());
+    BenchConfig &cfg = configs.back();
+    cfg.section      = strdup(sections[i].c_str());
+    cfg.pred         = BPredictor::getBPred(i, cfg.section, "");
+    if(cfg.pred == 0)
+      exit(-1);
+
+    for(int op = iBALU_LBRANCH; op <= iBALU_RET; op++) {
+      cfg.dinst[op][0] = createDInst(static_cast<InstOpcode>(op), false);
+      cfg.dinst[op][1] = createDInst(static_cast<InstOpcode>(op), true);
+    }
+    cfg.nBranches  = 0;
+    cfg.nMiss      = 0;
+    cfg.nNoPredict = 0;
+    cfg.secs       = 0;
+  }
+
+  traceInsts = BPredTraceReader::load(traceFile, trace);
+  MSG("bpredbench: %lld branches, %lld instructions, %d configs on %d threads", (long long)trace.size(), (long long)traceInsts,
+      (int)configs.size(), nThreads);
+
+  std::vector<pthread_t> threads(nThreads);
+  for(int32_t i = 0; i < nThreads; i++)
+    pthread_create(&threads[i], 0, worker, 0);
+  for(int32_t i = 0; i < nThreads; i++)
+    pthread_join(threads[i], 0);
+
+  for(size_t i = 0; i < configs.size(); i++) {
+    const BenchConfig &cfg = configs[i];
+
+    double mpki = traceInsts ? 1000.0 * cfg.nMiss / traceInsts : 0;
+    double acc  = cfg.nBranches ? 100.0 * (cfg.nBranches - cfg.nMiss) / cfg.nBranches : 0;
+    double kbps = cfg.secs > 0 ? trace.size() / cfg.secs / 1e3 : 0;
+
+    fprintf(stderr, "%-20s MPKI=%7.3f accuracy=%6.2f%% noPredict=%lld %10.0f Kbranches/s\n", cfg.section, mpki, acc,
+            (long long)cfg.nNoPredict, kbps);
+    Report::field("bpredbench:%s:nBranches=%lld:nMiss=%lld:nNoPredict=%lld:MPKI=%f:KbranchesPerSec=%f", cfg.section,
+                  (long long)cfg.nBranches, (long long)cfg.nMiss, (long long)cfg.nNoPredict, mpki, kbps);
+  }
+
+  GStats::report("bpredbench stats");
+  Report::close();
+}
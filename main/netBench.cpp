@@ -1,28 +1,43 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <sys/time.h>
 
+#include <string>
+#include <vector>
+
 #include "Report.h"
-//#include "ReportGen.h" This file doesn't exist. Replaced it with Report.h
 #include "InterConn.h"
 #include "ProtocolBase.h"
 #include "SescConf.h"
 
-// What does this do? Send some kind of message
+// NoC benchmark: synthetic traffic patterns injected at increasing rates on
+// every network listed in the [netBench] section. For each (network,
+// pattern, rate) it reports the average/max packet latency, the accepted
+// throughput and the host speed (messages simulated per second).
+//
+// use: netBench -c netBench.conf
+
+enum TrafficPattern { UniformRandom = 0, Transpose, Hotspot, BitComplement, MaxTrafficPattern };
+
+static const char *TrafficPatternName[MaxTrafficPattern] = {"uniform", "transpose", "hotspot", "bitcomp"};
+
 class PBTestMsg : public PMessage {
 private:
   static pool<PBTestMsg> msgPool;
   friend class pool<PBTestMsg>;
 
 public:
+  Time_t injectTime;
+  bool   measured; // Injected inside the measurement window
+
   static PBTestMsg *create(const ProtocolBase *srcPB, const ProtocolBase *dstPB) {
-    // ProtocolBase *src;
-    // src = (ProtocolBase *)srcPB; //Ehsan
-    // ProtocolBase *dst=dstPB;  //Ehsan
     PBTestMsg *msg = msgPool.out();
     msg->setupMessage((ProtocolBase *)srcPB, (ProtocolBase *)dstPB, TestMsg);
-    //  msg->setupMessage((ProtocolBase *)1, (ProtocolBase *)2, TestMsg);
+
+    msg->injectTime = globalClock;
+    msg->measured   = false;
 
     return msg;
   };
@@ -32,215 +47,326 @@ public:
   };
 };
 
-// What does this do? Send some kind of ACK message
-class PBTestAckMsg : public PMessage {
-private:
-  static pool<PBTestAckMsg> msgPool;
-  friend class pool<PBTestAckMsg>;
+pool<PBTestMsg> PBTestMsg::msgPool(1024);
 
+// Statistics for the current run
+class BenchStats {
 public:
-  static PBTestAckMsg *create(const ProtocolBase *srcPB, const ProtocolBase *dstPB) {
-    PBTestAckMsg *msg = msgPool.out();
-    msg->setupMessage((ProtocolBase *)srcPB, (ProtocolBase *)dstPB, TestAckMsg);
-    // edited by Ehsan (added typecast of srcPB and dstPB to( ProtocolBase *))
-    return msg;
-  };
-  void garbageCollect() {
-    msgPool.in(this);
-  };
+  uint64_t nInjected;  // measured packets injected
+  uint64_t nDelivered; // measured packets delivered
+  uint64_t nTotal;     // all the packets delivered (host speed)
+  uint64_t nWindow;    // all the packets delivered inside the measurement window
+  bool     inWindow;
+  double   latSum;
+  Time_t   latMax;
+
+  void clear() {
+    nInjected  = 0;
+    nDelivered = 0;
+    nTotal     = 0;
+    nWindow    = 0;
+    inWindow   = false;
+    latSum     = 0;
+    latMax     = 0;
+  }
 };
 
-// This is just some integer floating around in here
-// between the classes. Looks like some kind of counter
-// for the number of messages
-int32_t nMessages;
+BenchStats stats;
+uint64_t   nInFlight = 0; // across runs, the network is drained before it is deleted
 
-// Ok, a new class. What is ProtocolA?
-// And is the stuff under it part of the class? Just
-// Based on the indents, it looks like it.
 class ProtocolA : public ProtocolBase {
+private:
+  ProtocolCBBase *testCB;
+  ProtocolCBBase *defaultCB;
+
 public:
   ProtocolA(InterConnection *net, RouterID_t rID)
       : ProtocolBase(net, rID) {
 
-    ProtocolCBBase *pcb = new ProtocolCB<ProtocolA, &ProtocolA::TestHandler>(this);
-    registerHandler(pcb, TestMsg);
+    testCB = new ProtocolCB<ProtocolA, &ProtocolA::TestHandler>(this);
+    registerHandler(testCB, TestMsg);
 
-    pcb = new ProtocolCB<ProtocolA, &ProtocolA::TestAckHandler>(this);
-    registerHandler(pcb, TestAckMsg);
-
-    pcb = new ProtocolCB<ProtocolA, &ProtocolA::defaultHandler>(this);
-    registerHandler(pcb, DefaultMessage);
+    defaultCB = new ProtocolCB<ProtocolA, &ProtocolA::defaultHandler>(this);
+    registerHandler(defaultCB, DefaultMessage);
   };
+  ~ProtocolA() {
+    delete testCB;
+    delete defaultCB;
+  }
 
   void defaultHandler(Message *msg) {
     I(0);
-    nMessages++;
     msg->garbageCollect();
   };
 
   void TestHandler(Message *m) {
-    nMessages++;
-    PBTestMsg *    msg   = static_cast<PBTestMsg *>(m);
-    static uint8_t conta = 0;
-    conta++;
+    PBTestMsg *msg = static_cast<PBTestMsg *>(m);
 
     I(this == msg->getDstPB());
-    if(conta & 1) {
-      sendMsg(2, PBTestAckMsg::create(this, msg->getSrcPB()));
-    } else if(conta & 2) {
-      sendMsg(PBTestAckMsg::create(this, msg->getSrcPB()));
+
+    nInFlight--;
+    stats.nTotal++;
+    if(stats.inWindow)
+      stats.nWindow++;
+    if(msg->measured) {
+      Time_t lat = globalClock - msg->injectTime;
+      stats.nDelivered++;
+      stats.latSum += lat;
+      if(lat > stats.latMax)
+        stats.latMax = lat;
     }
-    msg->garbageCollect();
-  };
 
-  void TestAckHandler(Message *msg) {
-    nMessages++;
     msg->garbageCollect();
   };
 
-  // Added semicolon here--not sure if this is the right spot or not
+  void inject(ProtocolA *dst, bool measured) {
+    PBTestMsg *msg = PBTestMsg::create(this, dst);
+    msg->measured  = measured;
+    if(measured)
+      stats.nInjected++;
+    nInFlight++;
+    sendMsg(msg);
+  }
 };
 
-pool<PBTestMsg>    PBTestMsg::msgPool(1024);
-pool<PBTestAckMsg> PBTestAckMsg::msgPool(1024);
-
-#define NMSG 100000
-#define TIME_BUBBLE 128
-
-std::vector<ProtocolA *> pa;
-
-InterConnection *net;
-size_t           nRouters;
-
-Time_t  stClock;
-timeval stTime;
-timeval endTime;
+// Deterministic across runs and hosts (xorshift64*)
+class BenchRand {
+private:
+  uint64_t state;
 
-void startBench() {
-  gettimeofday(&stTime, 0);
-  stClock   = globalClock;
-  nMessages = 0;
+public:
+  BenchRand(uint64_t seed)
+      : state(seed ? seed : 0x9E3779B97F4A7C15ULL) {
+  }
+  uint64_t next() {
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    return state * 0x2545F4914F6CDD1DULL;
+  }
+  double nextDouble() {
+    return (next() >> 11) * (1.0 / 9007199254740992.0);
+  }
+  size_t nextRange(size_t n) {
+    return next() % n;
+  }
 };
 
-void endBench(const char *str) {
-  gettimeofday(&endTime, 0);
+class NetBench {
+private:
+  const char *section;
 
-  double msecs = (endTime.tv_sec - stTime.tv_sec) * 1000 + (endTime.tv_usec - stTime.tv_usec) / 1000;
+  InterConnection *        net;
+  std::vector<ProtocolA *> pa;
+  size_t                   nRouters;
 
-  fprintf(stderr, "%s: %8.2f KPackets/s or %8.2f Kclks/s\n", str, (double)nMessages / msecs,
-          (double)(globalClock - stClock) / msecs);
-};
+  BenchRand rnd;
 
-void bench1() {
-  // Two neighbours messages
+  size_t hotspotID;
+  double hotspotFrac;
 
-  for(int32_t i = 0; i < NMSG; i++) {
-    Message *msg = PBTestMsg::create(pa[nRouters / 2], pa[nRouters / 2 + 1]);
-    //   Message *msg = PBTestMsg::create(pa[1],pa[2]);
-    net->sendMsg(msg);
-    EventScheduler::advanceClock();
-    if((i % 128) == 0) {
-      for(int32_t k = 0; k < TIME_BUBBLE; k++) {
-        EventScheduler::advanceClock();
-      }
+  size_t uniformDst(size_t src) {
+    if(nRouters < 2)
+      return src;
+    size_t dst = rnd.nextRange(nRouters - 1);
+    return dst >= src ? dst + 1 : dst;
+  }
+
+  size_t calcDst(TrafficPattern p, size_t src) {
+    switch(p) {
+    case UniformRandom:
+      return uniformDst(src);
+    case Transpose: {
+      size_t w = 1;
+      while(w * w < nRouters)
+        w++;
+      if(w * w == nRouters)
+        return (src % w) * w + src / w;
+      // Not square, swap the two halves of the router id bits
+      short  bits = log2i(roundUpPower2(nRouters));
+      short  half = bits / 2;
+      size_t dst  = ((src & ((1 << half) - 1)) << (bits - half)) | (src >> half);
+      return dst < nRouters ? dst : src;
     }
+    case Hotspot:
+      if(rnd.nextDouble() < hotspotFrac && src != hotspotID)
+        return hotspotID;
+      return uniformDst(src);
+    case BitComplement:
+      if(ISPOWER2(nRouters))
+        return (~src) & (nRouters - 1);
+      return nRouters - 1 - src;
+    default:
+      I(0);
+    }
+    return src;
   }
 
-  for(int32_t k = 0; k < TIME_BUBBLE; k++) {
+  void injectCycle(TrafficPattern p, double rate, bool measured) {
+    for(size_t src = 0; src < nRouters; src++) {
+      if(rnd.nextDouble() >= rate)
+        continue;
+      size_t dst = calcDst(p, src);
+      if(dst == src)
+        continue; // Self traffic does not use the network (transpose diagonal)
+      pa[src]->inject(pa[dst], measured);
+    }
     EventScheduler::advanceClock();
   }
-};
 
-void bench2() {
-  // Lots of simultaneous messages
+public:
+  NetBench(const char *netSection, uint64_t seed)
+      : section(strdup(netSection))
+      , rnd(seed) {
+    net      = new InterConnection(section);
+    nRouters = net->getnRouters();
 
-  for(size_t i = 0; i < NMSG / nRouters; i++) {
-    for(size_t k = 0; k < nRouters; k++) {
-      //  Message *msg = PBTestMsg::create(pa[(k*7) % nRouters]
-               ,pa[(k*3)% nRouters]);
-               Message *msg = PBTestMsg::create(pa[(k * 5) % nRouters], pa[(k * 3) % nRouters]);
+    for(size_t i = 0; i < nRouters; i++)
+      pa.push_back(new ProtocolA(net, i));
 
-               net->sendMsg(msg);
-    }
-    EventScheduler::advanceClock();
-    if((i % 32) == 0) {
-      for(int32_t k = 0; k < TIME_BUBBLE; k++) {
-        EventScheduler::advanceClock();
-      }
-    }
+    hotspotID   = SescConf->getInt("netBench", "hotspotID") % nRouters;
+    hotspotFrac = SescConf->getDouble("netBench", "hotspotFrac");
   }
+  ~NetBench() {
+    drain(); // No event can be left for the routers or the handlers
 
-  for(int32_t k = 0; k < 4 * TIME_BUBBLE; k++) {
-    EventScheduler::advanceClock();
+    for(size_t i = 0; i < nRouters; i++)
+      delete pa[i];
+    delete net;
+    free((void *)section);
   }
-};
 
-/* Version 1 from Ehsan--fails at different point in gdb
-int32_t main(int32_t argc, char **argv, char **envp)
-{
-  if (argc<2) {
-    fprintf(stderr,"Usage:\n\t%s <router.conf>\n", argv[0]);
-    exit(0);
+  // Deliver everything in flight, the next network starts empty
+  void drain() {
+    while(nInFlight)
+      EventScheduler::advanceClock();
   }
 
-  Report::openFile("netBench.log");
+  // Returns false when the network did not drain (saturated)
+  bool run(TrafficPattern p, double rate, Time_t warmupCycles, Time_t measureCycles, Time_t drainCycles) {
+    stats.clear();
+
+    for(Time_t i = 0; i < warmupCycles; i++)
+      injectCycle(p, rate, false);
+
+    // The host speed covers only the timed part
+    stats.nTotal = 0;
+
+    timeval stTime;
+    gettimeofday(&stTime, 0);
+
+    stats.inWindow = true;
+    for(Time_t i = 0; i < measureCycles; i++)
+      injectCycle(p, rate, true);
+    stats.inWindow = false;
+
+    // Keep the background load while the measured packets drain
+    Time_t drain = 0;
+    while(stats.nDelivered < stats.nInjected && drain < drainCycles) {
+      injectCycle(p, rate, false);
+      drain++;
+    }
 
-  SescConf = new SConfig(argc, (const char **)argv);   // First thing to do
+    timeval endTime;
+    gettimeofday(&endTime, 0);
+    double usecs = (endTime.tv_sec - stTime.tv_sec) * 1e6 + (endTime.tv_usec - stTime.tv_usec);
 
- */
+    bool   drained  = stats.nDelivered == stats.nInjected;
+    double offered  = (double)stats.nInjected / (measureCycles * nRouters);
+    double accepted = (double)stats.nWindow / (measureCycles * nRouters);
+    double avgLat   = stats.nDelivered ? stats.latSum / stats.nDelivered : 0;
+    double msgsSec  = usecs > 0 ? stats.nTotal / usecs * 1e6 : 0;
+
+    fprintf(stderr, "%-12s %-10s rate=%5.3f offered=%6.4f accepted=%6.4f lat=%8.2f max=%6lld %10.0f msgs/s%s\n", section,
+            TrafficPatternName[p], rate, offered, accepted, avgLat, (long long)stats.latMax, msgsSec, drained ? "" : " (saturated)");
+
+    Report::field("netBench:%s:%s:rate=%f:offered=%f:accepted=%f:avgLat=%f:maxLat=%lld:msgsPerSec=%f:saturated=%d", section,
+                  TrafficPatternName[p], rate, offered, accepted, avgLat, (long long)stats.latMax, msgsSec, drained ? 0 : 1);
+
+    // Let the background traffic go before the next run
+    for(Time_t i = 0; i < drainCycles; i++)
+      EventScheduler::advanceClock();
+
+    return drained;
+  }
+};
+
+static TrafficPattern getPattern(const char *name) {
+  for(int i = 0; i < MaxTrafficPattern; i++) {
+    if(strcasecmp(name, TrafficPatternName[i]) == 0)
+      return static_cast<TrafficPattern>(i);
+  }
+  MSG("ERROR: netBench unknown traffic pattern [%s]", name);
+  exit(-1);
+}
+
+// Split "a b c" conf strings
+static std::vector<std::string> splitList(const char *str) {
+  std::vector<std::string> list;
+  std::string              cur;
+  for(const char *c = str; *c; c++) {
+    if(*c == ' ' || *c == '\t' || *c == ',') {
+      if(!cur.empty())
+        list.push_back(cur);
+      cur.clear();
+    } else {
+      cur += *c;
+    }
+  }
+  if(!cur.empty())
+    list.push_back(cur);
+  return list;
+}
 
-// Version 3 from Ehsan
 int32_t main(int32_t argc, char **argv, char **envp) {
   if(argc < 2) {
-    fprintf(stderr, "Usage:\n\t%s <router.conf>\n", argv[0]);
+    fprintf(stderr, "Usage:\n\t%s -c <netBench.conf>\n", argv[0]);
     exit(0);
   }
 
   Report::openFile("netBench.log");
-  // edited by ehsan
-  // SescConf = new SConfig(argv[1]);   // First thing to do
   SescConf = new SConfig(argc, (const char **)argv);
 
-  net = new InterConnection("network1");
+  const char *sec = "netBench";
 
-  nRouters = net->getnRouters();
+  std::vector<std::string> networks = splitList(SescConf->getCharPtr(sec, "networks"));
+  std::vector<std::string> patterns = splitList(SescConf->getCharPtr(sec, "patterns"));
 
-  for(size_t i = 0; i < nRouters; i++) {
-    ProtocolA *p = new ProtocolA(net, i);
-    pa.push_back(p);
-  }
+  double injRateMin  = SescConf->getDouble(sec, "injRateMin");
+  double injRateMax  = SescConf->getDouble(sec, "injRateMax");
+  double injRateStep = SescConf->getDouble(sec, "injRateStep");
+  SescConf->isBetween(sec, "injRateMin", 0, 1);
+  SescConf->isBetween(sec, "injRateMax", 0, 1);
+  SescConf->isGT(sec, "injRateStep", 0);
 
-  printf("System ready\n");
+  Time_t warmupCycles  = SescConf->getInt(sec, "warmupCycles");
+  Time_t measureCycles = SescConf->getInt(sec, "measureCycles");
+  Time_t drainCycles   = SescConf->getInt(sec, "drainCycles");
+  SescConf->isGT(sec, "measureCycles", 0);
 
-  fprintf(stderr, "Bench two neighbours message...");
-  startBench();
-  bench1();
-  fprintf(stderr, "done\n");
-  endBench("bench1");
+  uint64_t seed = SescConf->getInt(sec, "seed");
 
-  fprintf(stderr, "Bench heavy traffic...");
-  startBench();
-  bench2();
-  fprintf(stderr, "done\n");
-  endBench("bench2");
+  // Deleted after the report, the networks own their statistics
+  std::vector<NetBench *> benchs;
+  for(size_t n = 0; n < networks.size(); n++) {
+    benchs.push_back(new NetBench(networks[n].c_str(), seed));
+    NetBench &bench = *benchs.back();
 
-  fprintf(stderr, "Mix Benchmark...");
-  startBench();
-  bench2();
-  printf("one\n");
-  bench2();
-  printf("two\n");
-  bench1();
-  printf("three\n");
-  bench2();
-  fprintf(stderr, "done\n");
-  endBench("bench3");
+    for(size_t p = 0; p < patterns.size(); p++) {
+      TrafficPattern pattern = getPattern(patterns[p].c_str());
 
-  for(int32_t k = 0; k < TIME_BUBBLE * 100; k++) {
-    EventScheduler::advanceClock();
+      // Latency/throughput curve, stop at the first saturated point
+      for(double rate = injRateMin; rate <= injRateMax + 1e-9; rate += injRateStep) {
+        if(!bench.run(pattern, rate, warmupCycles, measureCycles, drainCycles))
+          break;
+      }
+    }
+    bench.drain();
   }
 
   GStats::report("netBench stats");
   Report::close();
+
+  for(size_t n = 0; n < benchs.size(); n++)
+    delete benchs[n];
 }
@@ -31,6 +31,8 @@ Temple Place - Suite 330, Boston, MA 02111-1307, USA.
 #include <string.h>
 #include <strings.h>
 
+#include <algorithm>
+
 #include "CacheCore.h"
 #include "SescConf.h"
 
@@ -47,7 +49,8 @@ Temple Place - Suite 330, Boston, MA 02111-1307, USA.
 // Class CacheGeneric, the combinational logic of Cache
 template <class State, class Addr_t>
 CacheGeneric<State, Addr_t> *CacheGeneric<State, Addr_t>::create(int32_t size, int32_t assoc, int32_t bsize, int32_t addrUnit,
-                                                                 const char *pStr, bool skew, bool xr, uint32_t shct_size) {
+                                                                 const char *pStr, bool skew, bool xr, uint32_t shct_size,
+                                                                 uint32_t hawkSampled, uint32_t uarTracker, bool lazy) {
   CacheGeneric *cache;
 
   if(size / bsize < assoc) {
@@ -62,6 +65,10 @@ CacheGeneric<State, Addr_t> *CacheGeneric<State, Addr_t>::create(int32_t size, i
     return 0;
   }
 
+  if(lazy && (skew || assoc == 1 || strcasecmp(pStr, k_SHIP) == 0 || strcasecmp(pStr, k_HAWKEYE) == 0)) {
+    MSG("WARNING: lazy cache storage is only supported by CacheAssoc, allocating all the lines");
+  }
+
   if(skew) {
     I(assoc == 1); // Skew cache should be direct map
     cache = new CacheDMSkew<State, Addr_t>(size, bsize, addrUnit, pStr);
@@ -73,17 +80,17 @@ CacheGeneric<State, Addr_t> *CacheGeneric<State, Addr_t>::create(int32_t size, i
     if(strcasecmp(pStr, k_SHIP) == 0) {
       cache = new CacheSHIP<State, Addr_t>(size, assoc, bsize, addrUnit, pStr, shct_size);
     } else if(strcasecmp(pStr, k_HAWKEYE) == 0) {
-      cache = new HawkCache<State, Addr_t>(size, assoc, bsize, addrUnit, pStr, xr);
+      cache = new HawkCache<State, Addr_t>(size, assoc, bsize, addrUnit, pStr, xr, hawkSampled);
     } else {
-      cache = new CacheAssoc<State, Addr_t>(size, assoc, bsize, addrUnit, pStr, xr);
+      cache = new CacheAssoc<State, Addr_t>(size, assoc, bsize, addrUnit, pStr, xr, uarTracker, lazy);
     }
   } else {
     if(strcasecmp(pStr, k_SHIP) == 0) {
       cache = new CacheSHIP<State, Addr_t>(size, assoc, bsize, addrUnit, pStr, shct_size);
     } else if(strcasecmp(pStr, k_HAWKEYE) == 0) {
-      cache = new HawkCache<State, Addr_t>(size, assoc, bsize, addrUnit, pStr, xr);
+      cache = new HawkCache<State, Addr_t>(size, assoc, bsize, addrUnit, pStr, xr, hawkSampled);
     } else {
-      cache = new CacheAssoc<State, Addr_t>(size, assoc, bsize, addrUnit, pStr, xr);
+      cache = new CacheAssoc<State, Addr_t>(size, assoc, bsize, addrUnit, pStr, xr, uarTracker, lazy);
     }
   }
 
@@ -111,6 +118,8 @@ template <class State, class Addr_t> void CacheGeneric<State, Addr_t>::createSta
   trackerDown2n = new GStatsCntr("%s_trackerDown2n", name);
   trackerDown3n = new GStatsCntr("%s_trackerDown3n", name);
   trackerDown4n = new GStatsCntr("%s_trackerDown4n", name);
+  trackerMiss   = new GStatsCntr("%s_trackerMiss", name);
+  trackerEvict  = new GStatsCntr("%s_trackerEvict", name);
 #if 0
   int32_t procId = 0;
   if ( name[0] == 'P' && name[1] == '(' ) {
@@ -168,10 +177,28 @@ CacheGeneric<State, Addr_t> *CacheGeneric<State, Addr_t>::create(const char *sec
     shct_size = SescConf->getInt(section, "ship_signature_bits");
   }
 
+  // HAWKEYE
+  uint32_t hawkSampled = 64;
+  if(strcasecmp(pStr, k_HAWKEYE) == 0 && SescConf->checkInt(section, "hawkeye_sampled_sets")) {
+    if(SescConf->isGT(section, "hawkeye_sampled_sets", 0) && SescConf->isPower2(section, "hawkeye_sampled_sets"))
+      hawkSampled = SescConf->getInt(section, "hawkeye_sampled_sets");
+  }
+
+  // UAR
+  uint32_t uarTracker = 1024;
+  if(strcasecmp(pStr, k_UAR) == 0 && SescConf->checkInt(section, "uar_tracker_size")) {
+    if(SescConf->isGT(section, "uar_tracker_size", 3) && SescConf->isPower2(section, "uar_tracker_size"))
+      uarTracker = SescConf->getInt(section, "uar_tracker_size");
+  }
+
+  bool lazy = false;
+  if(SescConf->checkBool(section, "lazyStorage"))
+    lazy = SescConf->getBool(section, "lazyStorage");
+
   if(SescConf->isGT(section, size, 0) && SescConf->isGT(section, bsize, 0) && SescConf->isGT(section, assoc, 0) &&
      SescConf->isPower2(section, size) && SescConf->isPower2(section, bsize) && SescConf->isPower2(section, assoc) &&
      SescConf->isInList(section, repl, k_RANDOM, k_LRU, k_SHIP, k_LRUp, k_HAWKEYE, k_PAR, k_UAR)) {
-    cache = create(s, a, b, u, pStr, sk, xr, shct_size);
+    cache = create(s, a, b, u, pStr, sk, xr, shct_size, hawkSampled, uarTracker, lazy);
   } else {
     // this is just to keep the configuration going,
     // sesc will abort before it begins
@@ -193,12 +220,30 @@ CacheGeneric<State, Addr_t> *CacheGeneric<State, Addr_t>::create(const char *sec
   return cache;
 }
 
+template <class State, class Addr_t>
+void CacheGeneric<State, Addr_t>::groupBySet(const Addr_t *addr, size_t n, std::vector<uint32_t> &order) const {
+  order.resize(n);
+  for(size_t i = 0; i < n; i++)
+    order[i] = i;
+
+  if(!isSetIndependent() || n < 2)
+    return;
+
+  std::vector<Addr_t> setIndex(n);
+  for(size_t i = 0; i < n; i++)
+    setIndex[i] = calcIndex4Tag(calcTag(addr[i]));
+
+  // Stable, so the accesses to a given set keep the original order
+  std::stable_sort(order.begin(), order.end(), [&setIndex](uint32_t a, uint32_t b) { return setIndex[a] < setIndex[b]; });
+}
+
 /*********************************************************
  *  CacheAssoc
  *********************************************************/
 
 template <class State, class Addr_t>
-CacheAssoc<State, Addr_t>::CacheAssoc(int32_t size, int32_t assoc, int32_t blksize, int32_t addrUnit, const char *pStr, bool xr)
+CacheAssoc<State, Addr_t>::CacheAssoc(int32_t size, int32_t assoc, int32_t blksize, int32_t addrUnit, const char *pStr, bool xr,
+                                      uint32_t trackerSize, bool lazy)
     : CacheGeneric<State, Addr_t>(size, assoc, blksize, addrUnit, xr) {
   I(numLines > 0);
 
@@ -220,6 +265,21 @@ CacheAssoc<State, Addr_t>::CacheAssoc(int32_t size, int32_t assoc, int32_t blksi
     exit(0);
   }
 
+  if(policy == UAR)
+    pcTracker.setSize(trackerSize);
+
+  irand = 0;
+
+  lazyContent = 0;
+  lazyUsed    = 0;
+  lazyBlksize = blksize;
+  if(lazy) {
+    mem     = 0;
+    content = 0;
+    lazySet.resize(sets, 0);
+    return;
+  }
+
   mem = (Line *)malloc(sizeof(Line) * (numLines + 1));
   ////read
   for(uint32_t i = 0; i < numLines; i++) {
@@ -233,15 +293,45 @@ CacheAssoc<State, Addr_t>::CacheAssoc(int32_t size, int32_t assoc, int32_t blksi
     mem[i].rrip = 0;
     content[i]  = &mem[i];
   }
+}
 
-  irand = 0;
+template <class State, class Addr_t>
+typename CacheAssoc<State, Addr_t>::Line **CacheAssoc<State, Addr_t>::allocateSet(Addr_t index) {
+  I(!content);
+
+  uint32_t chunkLines = assoc > LazyChunkLines ? assoc : LazyChunkLines;
+  if(lazyChunk.empty() || lazyUsed + assoc > chunkLines) {
+    // Lines and set pointers share the chunk
+    lazyChunk.push_back((Line *)malloc((sizeof(Line) + sizeof(Line *)) * chunkLines));
+    lazyContent = (Line **)(lazyChunk.back() + chunkLines);
+    lazyUsed    = 0;
+  }
+
+  Line * lines  = lazyChunk.back() + lazyUsed;
+  Line **theSet = lazyContent + lazyUsed;
+  lazyUsed += assoc;
+
+  for(uint32_t i = 0; i < assoc; i++) {
+    new(&lines[i]) Line(lazyBlksize);
+    lines[i].initialize(this);
+    lines[i].invalidate();
+    lines[i].rrip = 0;
+    theSet[i]     = &lines[i];
+  }
+
+  lazySet[index >> this->log2Assoc] = theSet;
+  return theSet;
 }
 
 template <class State, class Addr_t>
 typename CacheAssoc<State, Addr_t>::Line *CacheAssoc<State, Addr_t>::findLineNoEffectPrivate(Addr_t addr) {
-  Addr_t tag = this->calcTag(addr);
+  Addr_t tag   = this->calcTag(addr);
+  Addr_t index = this->calcIndex4Tag(tag);
 
-  Line **theSet = &content[this->calcIndex4Tag(tag)];
+  if(!content && lazySet[index >> this->log2Assoc] == 0)
+    return 0; // Set never touched (lazy storage)
+
+  Line **theSet = getSet(index);
 
   // Check most typical case
   if((*theSet)->getTag() == tag) {
@@ -274,7 +364,7 @@ template <class State, class Addr_t>
 typename CacheAssoc<State, Addr_t>::Line *CacheAssoc<State, Addr_t>::findLinePrivate(Addr_t addr, Addr_t pc) {
   Addr_t tag = this->calcTag(addr);
 
-  Line **theSet = &content[this->calcIndex4Tag(tag)];
+  Line **theSet = getSet(this->calcIndex4Tag(tag));
   Line **setEnd = theSet + assoc;
 
   // Check most typical case
@@ -291,8 +381,8 @@ typename CacheAssoc<State, Addr_t>::Line *CacheAssoc<State, Addr_t>::findLinePri
       }
       if(policy == UAR) {
         (*theSet)->incnDemand();
-        if(next_rrip > 0 && pc2tracker[(*theSet)->getPC()].conf > 8 &&
-           (1 + pc2tracker[(*theSet)->getPC()].demand_trend) < (*theSet)->getnDemand()) {
+        const Tracker &t = getTracker((*theSet)->getPC());
+        if(next_rrip > 0 && t.conf > 8 && (1 + t.demand_trend) < (*theSet)->getnDemand()) {
           trackerDown3->inc();
           next_rrip /= 2;
         } else {
@@ -347,7 +437,8 @@ typename CacheAssoc<State, Addr_t>::Line *CacheAssoc<State, Addr_t>::findLinePri
   if(policy == UAR) {
     tmp->incnDemand();
     // MSG("2inc pc:%llx",(tmp)->getPC());
-    if(pc2tracker[tmp->getPC()].conf > 8 && (1 + pc2tracker[tmp->getPC()].demand_trend) < tmp->getnDemand() && next_rrip > 0) {
+    const Tracker &t = getTracker(tmp->getPC());
+    if(t.conf > 8 && (1 + t.demand_trend) < tmp->getnDemand() && next_rrip > 0) {
       trackerDown4->inc();
       next_rrip /= 2;
     } else {
@@ -377,7 +468,7 @@ template <class State, class Addr_t>
 typename CacheAssoc<State, Addr_t>::Line *CacheAssoc<State, Addr_t>::findLine2Replace(Addr_t addr, Addr_t pc, bool prefetch) {
   Addr_t tag = this->calcTag(addr);
   I(tag);
-  Line **theSet = &content[this->calcIndex4Tag(tag)];
+  Line **theSet = getSet(this->calcIndex4Tag(tag));
   Line **setEnd = theSet + assoc;
 
 #if 0
@@ -424,7 +515,7 @@ typename CacheAssoc<State, Addr_t>::Line *CacheAssoc<State, Addr_t>::findLine2Re
       else if((*l)->rrip < (*lineFree)->rrip) // == too to add a bit of LRU order between same RIPs
         lineFree = l;
       else if(policy == UAR && ((*l)->rrip == (*lineFree)->rrip)) {
-        if(pc2tracker[(*l)->getPC()].demand_trend < pc2tracker[(*lineFree)->getPC()].demand_trend)
+        if(getTracker((*l)->getPC()).demand_trend < getTracker((*lineFree)->getPC()).demand_trend)
           lineFree = l;
       }
 
@@ -462,7 +553,11 @@ typename CacheAssoc<State, Addr_t>::Line *CacheAssoc<State, Addr_t>::findLine2Re
   }
 
   if(tmp->isValid() && policy == UAR) {
-    pc2tracker[tmp->getPC()].done(tmp->getnDemand());
+    bool     evicted;
+    Tracker &t = pcTracker.findAlloc(tmp->getPC(), evicted);
+    if(evicted)
+      trackerEvict->inc();
+    t.done(tmp->getnDemand());
     if(tmp->getnDemand() == 0) {
       trackerZero->inc();
     } else if(tmp->getnDemand() == 1) {
@@ -473,7 +568,7 @@ typename CacheAssoc<State, Addr_t>::Line *CacheAssoc<State, Addr_t>::findLine2Re
       trackerMore->inc();
     }
 
-    trackstats[pc2tracker[tmp->getPC()].conf]->inc();
+    trackstats[t.conf]->inc();
   }
   tmp->setPC(pc);
 
@@ -482,7 +577,8 @@ typename CacheAssoc<State, Addr_t>::Line *CacheAssoc<State, Addr_t>::findLine2Re
       adjustRRIP(theSet, setEnd, tmp, 0);
     } else if(policy == UAR) {
       uint16_t default_rrip_prefetch = 0;
-      if(pc2tracker[pc].conf > 0 && pc2tracker[pc].demand_trend > 0) {
+      const Tracker &t = getTracker(pc);
+      if(t.conf > 0 && t.demand_trend > 0) {
         default_rrip_prefetch = RRIP_MAX / 2;
         trackerUp1->inc();
       } else {
@@ -498,10 +594,11 @@ typename CacheAssoc<State, Addr_t>::Line *CacheAssoc<State, Addr_t>::findLine2Re
 
     uint16_t default_rrip = RRIP_MAX;
     if(policy == UAR) {
-      if(pc2tracker[pc].conf > 8 && pc2tracker[pc].demand_trend == 0) {
+      const Tracker &t = getTracker(pc);
+      if(t.conf > 8 && t.demand_trend == 0) {
         default_rrip = 0;
         trackerDown1->inc();
-      } else if(pc2tracker[pc].conf > 8 && pc2tracker[pc].demand_trend == 1) {
+      } else if(t.conf > 8 && t.demand_trend == 1) {
         default_rrip /= 2;
         trackerDown2->inc();
       } else {
@@ -552,7 +649,8 @@ typename CacheAssoc<State, Addr_t>::Line *CacheAssoc<State, Addr_t>::findLine2Re
  *********************************************************/
 
 template <class State, class Addr_t>
-HawkCache<State, Addr_t>::HawkCache(int32_t size, int32_t assoc, int32_t blksize, int32_t addrUnit, const char *pStr, bool xr)
+HawkCache<State, Addr_t>::HawkCache(int32_t size, int32_t assoc, int32_t blksize, int32_t addrUnit, const char *pStr, bool xr,
+                                    uint32_t nSampled)
     : CacheGeneric<State, Addr_t>(size, assoc, blksize, addrUnit, xr) {
   I(numLines > 0);
 
@@ -580,14 +678,77 @@ HawkCache<State, Addr_t>::HawkCache(int32_t size, int32_t assoc, int32_t blksize
   prediction.resize(512);
   predictionMask = prediction.size() - 1;
 
-  usageInterval.resize(8192);
-  usageIntervalMask = usageInterval.size() - 1;
+  uint32_t nSets = this->getNumSets();
+  if(nSampled > nSets)
+    nSampled = nSets;
+  sampledShift = log2i(nSets / nSampled);
+  sampledMask  = (1 << sampledShift) - 1;
+  histLen      = 8 * assoc;
+
+  setTime.resize(nSampled, 0);
+  occupancy.resize(nSampled * histLen, 0);
+  sampler.resize(nSampled * histLen);
+  for(size_t i = 0; i < sampler.size(); i++)
+    sampler[i].valid = false;
+}
 
-  trackedAddresses.resize(8192);
-  trackedAddresses_ptr = 0;
+template <class State, class Addr_t> void HawkCache<State, Addr_t>::updateOPTgen(Addr_t tag, Addr_t set, uint16_t pcHash) {
+  uint32_t      s   = set >> sampledShift;
+  uint16_t *    occ = &occupancy[s * histLen];
+  SamplerEntry *e   = &sampler[s * histLen];
+  SamplerEntry *end = e + histLen;
+
+  uint32_t now  = setTime[s]++;
+  uint16_t stag = getSamplerTag(tag);
+
+  SamplerEntry *hit    = 0;
+  SamplerEntry *victim = e;
+  for(; e < end; e++) {
+    if(!e->valid) {
+      if(victim->valid)
+        victim = e;
+      continue;
+    }
+    if(e->tag == stag) {
+      hit = e;
+      break;
+    }
+    if(victim->valid && (now - e->time) > (now - victim->time))
+      victim = e;
+  }
 
-  occupancyVector.resize(8192);
-  occVectIterator = 0;
+  occ[now % histLen] = 0; // New quantum
+
+  if(hit) {
+    bool optHit = false;
+    if((now - hit->time) < histLen) {
+      // OPT keeps the line if the set had room during the whole usage interval
+      optHit = true;
+      for(uint32_t t = hit->time; t != now; t++) {
+        if(occ[t % histLen] >= assoc) {
+          optHit = false;
+          break;
+        }
+      }
+      if(optHit) {
+        for(uint32_t t = hit->time; t != now; t++)
+          occ[t % histLen]++;
+      }
+    }
+    // The load that brought the line is the one trained
+    train(hit->pcHash, optHit);
+    e = hit;
+  } else {
+    // Dropping a line that was never reused, OPT would not have cached it
+    if(victim->valid)
+      train(victim->pcHash, false);
+    e        = victim;
+    e->tag   = stag;
+    e->valid = true;
+  }
+
+  e->time   = now;
+  e->pcHash = pcHash;
 }
 
 template <class State, class Addr_t>
@@ -627,20 +788,15 @@ template <class State, class Addr_t>
 typename HawkCache<State, Addr_t>::Line *HawkCache<State, Addr_t>::findLinePrivate(Addr_t addr, Addr_t pc) {
   Addr_t tag = this->calcTag(addr);
 
-  Line **theSet = &content[this->calcIndex4Tag(tag)];
-
-  // Check most typical case
-  if((*theSet)->getTag() == tag) {
-    // JustDirectory can break this I((*theSet)->isValid());
-    return *theSet;
-  }
+  Addr_t index  = this->calcIndex4Tag(tag);
+  Line **theSet = &content[index];
 
   Line **lineHit = 0;
   Line **setEnd  = theSet + assoc;
 
-  // For sure that position 0 is not (short-cut)
+  // No short-cut for position 0, every access trains the sampled sets
   {
-    Line **l = theSet + 1;
+    Line **l = theSet;
     while(l < setEnd) {
       if((*l)->getTag() == tag) {
         lineHit = l;
@@ -651,101 +807,18 @@ typename HawkCache<State, Addr_t>::Line *HawkCache<State, Addr_t>::findLinePriva
   }
 
   // hawkeye
-  uint8_t OPToutcome  = 0;
-  uint8_t missFlag    = 0;
-  int     occVectSize = 8192;
-  int     trAddSize   = 8192;
-  int     curAddr     = 0;
-
-  int hashAddr = getUsageIntervalHash(addr);
-
   int predHPC = getPredictionHash(pc);
 
-  // OPTgen -----------------
-  occVectIterator++;
-  if(occVectIterator >= occVectSize) {
-    occVectIterator = 0;
-    for(int i = 0; i < occVectSize; i++) {
-      occupancyVector[i] = 0;
-    }
-  }
-  for(int i = 0; i < trAddSize; i++) { // Update usage interval for all tracked addresses
-    if(trackedAddresses[i] == 0)
-      continue;
-    if(trackedAddresses[i] == tag) {
-      curAddr = i;
-    }
-
-    if(usageInterval[getUsageIntervalHash(trackedAddresses[i])] < 255)
-      usageInterval[getUsageIntervalHash(trackedAddresses[i])]++;
-  }
-
-  if(usageInterval[hashAddr] > 0) { // Address has been loaded before
-    int limit = occVectIterator - usageInterval[hashAddr];
-    if(limit < 0) {
-      limit = 0;
-    } else if(limit >= occVectSize) {
-      limit = occVectSize - 1;
-    }
-    for(int i = limit; i < occVectIterator; i++) {
-      if(occupancyVector[i] >= numLines) {
-        missFlag = 1;
-        break; // If cache is full during usage interval, then it will miss
-      }
-    }
-
-    // If it doesn't miss, increase occupancy vector during liveness interval
-    if(missFlag != 1) {
-      for(int i = limit; i < occVectIterator; i++) {
-        if(occupancyVector[i] < 255)
-          occupancyVector[i]++;
-      }
-      usageInterval[hashAddr]   = 0;
-      trackedAddresses[curAddr] = 0;
-    }
-  } else { // Current address hasn't been loaded yet
-    usageInterval[hashAddr] = 1;
-
-    // Start tracking current address;
-    bool found = false;
-    for(int i = 0; i < trAddSize; i++) {
-      if(trackedAddresses[i] == tag || trackedAddresses[i] == 0) {
-        found               = true;
-        trackedAddresses[i] = tag;
-        break;
-      }
-    }
-    if(!found) {
-      trackedAddresses[trackedAddresses_ptr++] = tag;
-      if(trackedAddresses_ptr >= trackedAddresses.size())
-        trackedAddresses_ptr = 0;
-    }
-  }
-
-  // 0 means it predicts a miss, 1 means it predicts a hit
-  if(missFlag == 1) {
-    OPToutcome = 0;
-  } else {
-    OPToutcome = 1;
-  }
-
-  // Hawkeye prediction ---------------
-  if(OPToutcome == 1) {
-    if(prediction[predHPC] < 7) {
-      prediction[predHPC]++;
-    }
-  } else {
-    if(prediction[predHPC] > 0) {
-      prediction[predHPC]--;
-    }
-  }
+  Addr_t set = index >> log2Assoc;
+  if((set & sampledMask) == 0)
+    updateOPTgen(tag, set, predHPC);
 
   // A prediction of 0 is cache-averse, 1 is friendly
   uint8_t hawkPrediction = prediction[predHPC] >> 2;
 
   if(lineHit == 0) {
     if(hawkPrediction == 1) { // if predict friendly and cache miss, age all lines;
-      Line **l = theSet + 1;
+      Line **l = theSet;
       while(l < setEnd) {
         if((*l)->isValid() && (*l)->rrip < 6) {
           (*l)->rrip++;
@@ -808,25 +881,23 @@ typename HawkCache<State, Addr_t>::Line *HawkCache<State, Addr_t>::findLine2Repl
 
   I(lineFree);
 
-  Line **l   = setEnd - 1;
-  Line **tmp = lineFree;
-  // iterate through each cacheline and free the first one with rrip of 7
-  while(l >= theSet) {
-    if((*l)->isValid() && (*l)->rrip == 7) {
-      lineFree = l;
-      break;
+  if((*lineFree)->isValid()) {
+    // Cache-averse lines (rrip 7) go first, otherwise the oldest friendly line
+    Line **l = setEnd - 1;
+    lineFree = l;
+    while(l >= theSet) {
+      if((*l)->rrip > (*lineFree)->rrip)
+        lineFree = l;
+      l--;
     }
-    l--;
-  }
 
-  // if no lines have rrip == 7, revert to LRU and detrain hawk prediction
-  if(lineFree == tmp && (*lineFree)->rrip != 7) {
-    lineFree = setEnd - 1;
-    if(prediction[getPredictionHash(pc)] > 0)
+    // Evicting a friendly line, detrain hawk prediction
+    if((*lineFree)->rrip != 7 && prediction[getPredictionHash(pc)] > 0)
       prediction[getPredictionHash(pc)]--;
   }
 
-  I(lineFree);
+  // Friendly lines are inserted with the highest priority, averse ones first to go
+  (*lineFree)->rrip = (prediction[getPredictionHash(pc)] >> 2) ? 0 : 7;
 
   return *lineFree;
 }
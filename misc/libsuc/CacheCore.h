@@ -95,6 +95,8 @@ protected:
   GStatsCntr *trackerDown2n;
   GStatsCntr *trackerDown3n;
   GStatsCntr *trackerDown4n;
+  GStatsCntr *trackerMiss;  // UAR lookups of a PC not in the tracker
+  GStatsCntr *trackerEvict; // UAR tracked PCs replaced by another PC
 
 public:
   class CacheLine : public State {
@@ -147,7 +149,10 @@ public:
   // Do not use this interface, use other create
   static CacheGeneric<State, Addr_t> *create(int32_t size, int32_t assoc, int32_t blksize, int32_t addrUnit, const char *pStr,
                                              bool skew, bool xr,
-                                             uint32_t shct_size = 13); // 13 is the optimal size specified in the paper
+                                             uint32_t shct_size   = 13,    // 13 is the optimal size specified in the paper
+                                             uint32_t hawkSampled = 64,    // OPTgen sampled sets (Hawkeye)
+                                             uint32_t uarTracker  = 1024,  // PC tracker entries (UAR)
+                                             bool     lazy        = false); // allocate the sets on first touch
   static CacheGeneric<State, Addr_t> *create(const char *section, const char *append, const char *format, ...);
   void                                destroy() {
     delete this;
@@ -155,6 +160,16 @@ public:
 
   virtual CacheLine *findLine2Replace(Addr_t addr, Addr_t pc, bool prefetch) = 0;
 
+  // True when the replacement state of a set only depends on the accesses to
+  // that set. Then a batch of accesses can be reordered by set.
+  virtual bool isSetIndependent() const {
+    return false;
+  }
+
+  // Bulk lookup order: stable permutation of [0..n) that groups the addresses
+  // by set (identity if the policy is not set independent).
+  void groupBySet(const Addr_t *addr, size_t n, std::vector<uint32_t> &order) const;
+
   // TO DELETE if flush from Cache.cpp is cleared.  At least it should have a
   // cleaner interface so that Cache.cpp does not touch the internals.
   //
@@ -306,6 +321,7 @@ public:
 template <class State, class Addr_t> class HawkCache : public CacheGeneric<State, Addr_t> {
   using CacheGeneric<State, Addr_t>::numLines;
   using CacheGeneric<State, Addr_t>::assoc;
+  using CacheGeneric<State, Addr_t>::log2Assoc;
   using CacheGeneric<State, Addr_t>::maskAssoc;
   using CacheGeneric<State, Addr_t>::goodInterface;
 
@@ -322,21 +338,42 @@ protected:
   std::vector<uint8_t> prediction;
   uint32_t             predictionMask;
 
-  std::vector<uint8_t> usageInterval;
-  uint32_t             usageIntervalMask;
+  // OPTgen runs only on the sampled sets (set & sampledMask == 0). Each one
+  // has an occupancy vector covering the last histLen accesses to the set
+  // (8x assoc) and a sampler with the lines accessed in that window, so an
+  // access costs O(assoc) and the other sets only use the predictor.
+  struct SamplerEntry {
+    uint32_t time;   // set access count at the last access
+    uint16_t tag;    // hashed tag
+    uint16_t pcHash; // predictor entry of the last access
+    bool     valid;
+  };
 
-  std::vector<uint8_t> occupancyVector;
-  int                  trackedAddresses_ptr;
-  std::vector<Addr_t>  trackedAddresses;
+  uint32_t                  sampledMask;
+  uint32_t                  sampledShift;
+  uint32_t                  histLen;
+  std::vector<uint32_t>     setTime;   // per sampled set
+  std::vector<uint16_t>     occupancy; // [sampled set][histLen]
+  std::vector<SamplerEntry> sampler;   // [sampled set][histLen]
 
-  int occVectIterator;
+  uint16_t getSamplerTag(Addr_t tag) const {
+    uint64_t t = tag;
+    t          = t ^ (t >> 16) ^ (t >> 32);
+    return t & 0xFFFF;
+  }
 
-  int getUsageIntervalHash(Addr_t addr) const {
-    addr = addr >> CacheGeneric<State, Addr_t>::log2AddrLs; // Drop lower bits (line size)
-    addr = (addr >> 5) ^ (addr);
-    return addr & (numLines - 1);
+  void train(uint16_t pcHash, bool optHit) {
+    if(optHit) {
+      if(prediction[pcHash] < 7)
+        prediction[pcHash]++;
+    } else {
+      if(prediction[pcHash] > 0)
+        prediction[pcHash]--;
+    }
   }
 
+  void updateOPTgen(Addr_t tag, Addr_t set, uint16_t pcHash);
+
   int getPredictionHash(Addr_t pc) const {
     pc = pc >> 2; // psudo-PC works, no need lower 2 bit
 
@@ -346,7 +383,7 @@ protected:
   };
 
   friend class CacheGeneric<State, Addr_t>;
-  HawkCache(int32_t size, int32_t assoc, int32_t blksize, int32_t addrUnit, const char *pStr, bool xr);
+  HawkCache(int32_t size, int32_t assoc, int32_t blksize, int32_t addrUnit, const char *pStr, bool xr, uint32_t nSampled);
 
   Line *findLineNoEffectPrivate(Addr_t addr);
   Line *findLinePrivate(Addr_t addr, Addr_t pc = 0);
@@ -367,10 +404,122 @@ public:
   Line *findLine2Replace(Addr_t addr, Addr_t pc, bool prefetch);
 };
 
+// Usage (demand hits per fill) trend of the lines brought by each PC, used by
+// UAR. Bounded set associative table: a PC not tracked reads as the default
+// tracker, and a new PC replaces the coldest entry of its set (lowest
+// confidence, not recently used).
+template <class Addr_t> class PCTracker {
+public:
+  struct Tracker {
+    int demand_trend;
+    int conf;
+    Tracker() {
+      demand_trend = -1;
+      conf         = 0;
+    }
+    void done(int nDemand) {
+      if(demand_trend < 0) {
+        demand_trend = nDemand;
+      } else if(demand_trend == nDemand) {
+        if(conf < 15)
+          conf++;
+      } else {
+        if(conf > 0 && (demand_trend >> 1) != (nDemand >> 1)) {
+          conf--;
+        }
+        demand_trend = (nDemand + demand_trend) / 2;
+        if(nDemand && nDemand > demand_trend)
+          demand_trend++;
+      }
+    }
+  };
+
+private:
+  static const uint32_t Ways = 4;
+
+  struct Entry {
+    Addr_t  pc;
+    Tracker t;
+    bool    valid;
+    bool    used; // Second chance for replacement
+  };
+
+  std::vector<Entry> table;
+  uint32_t           maskSets;
+  uint32_t           log2Sets;
+
+  Entry *getSet(Addr_t pc) {
+    Addr_t h = pc >> 2;
+    h        = h ^ (h >> log2Sets);
+    return &table[(h & maskSets) * Ways];
+  }
+
+public:
+  PCTracker()
+      : maskSets(0)
+      , log2Sets(0) {
+  }
+
+  void setSize(uint32_t nEntries) {
+    I(nEntries >= Ways);
+    table.resize(nEntries);
+    for(size_t i = 0; i < table.size(); i++) {
+      table[i].valid = false;
+      table[i].used  = false;
+    }
+    log2Sets = log2i(nEntries / Ways);
+    maskSets = (nEntries / Ways) - 1;
+  }
+
+  // 0 if pc is not tracked
+  const Tracker *find(Addr_t pc) {
+    Entry *e = getSet(pc);
+    for(uint32_t i = 0; i < Ways; i++, e++) {
+      if(e->valid && e->pc == pc) {
+        e->used = true;
+        return &e->t;
+      }
+    }
+    return 0;
+  }
+
+  // Tracker for pc, replacing another PC if needed (evicted set)
+  Tracker &findAlloc(Addr_t pc, bool &evicted) {
+    Entry *set    = getSet(pc);
+    Entry *victim = set;
+    evicted       = false;
+    for(uint32_t i = 0; i < Ways; i++) {
+      Entry *e = &set[i];
+      if(!e->valid) {
+        if(victim->valid)
+          victim = e;
+        continue;
+      }
+      if(e->pc == pc) {
+        e->used = true;
+        return e->t;
+      }
+      if(victim->valid && (e->t.conf * 2 + e->used) < (victim->t.conf * 2 + victim->used))
+        victim = e;
+    }
+
+    evicted = victim->valid;
+    for(uint32_t i = 0; i < Ways; i++)
+      set[i].used = false;
+
+    victim->pc    = pc;
+    victim->t     = Tracker();
+    victim->valid = true;
+    victim->used  = true;
+    return victim->t;
+  }
+};
+
 template <class State, class Addr_t> class CacheAssoc : public CacheGeneric<State, Addr_t> {
   using CacheGeneric<State, Addr_t>::numLines;
   using CacheGeneric<State, Addr_t>::assoc;
   using CacheGeneric<State, Addr_t>::maskAssoc;
+  using CacheGeneric<State, Addr_t>::sets;
   using CacheGeneric<State, Addr_t>::goodInterface;
   using CacheGeneric<State, Addr_t>::trackstats;
   using CacheGeneric<State, Addr_t>::trackerZero;
@@ -387,6 +536,8 @@ template <class State, class Addr_t> class CacheAssoc : public CacheGeneric<Stat
   using CacheGeneric<State, Addr_t>::trackerDown2n;
   using CacheGeneric<State, Addr_t>::trackerDown3n;
   using CacheGeneric<State, Addr_t>::trackerDown4n;
+  using CacheGeneric<State, Addr_t>::trackerMiss;
+  using CacheGeneric<State, Addr_t>::trackerEvict;
 
 private:
 public:
@@ -398,34 +549,40 @@ protected:
   uint16_t          irand;
   ReplacementPolicy policy;
 
-  struct Tracker {
-    int demand_trend;
-    int conf;
-    Tracker() {
-      demand_trend = -1;
-      conf         = 0;
-    }
-    void done(int nDemand) {
-      if(demand_trend < 0) {
-        demand_trend = nDemand;
-      } else if(demand_trend == nDemand) {
-        if(conf < 15)
-          conf++;
-      } else {
-        if(conf > 0 && (demand_trend >> 1) != (nDemand >> 1)) {
-          conf--;
-        }
-        demand_trend = (nDemand + demand_trend) / 2;
-        if(nDemand && nDemand > demand_trend)
-          demand_trend++;
-      }
-    }
-  };
+  // Lazy storage: mem/content are not allocated, each set is allocated
+  // from a chunk of lines when first touched (lazySet[set] is 0 until
+  // then). Huge caches only pay for the footprint touched.
+  enum { LazyChunkLines = 4096 };
+  std::vector<Line **> lazySet;
+  std::vector<Line *>  lazyChunk;
+  Line **              lazyContent;
+  uint32_t             lazyUsed; // lines used in the last chunk
+  int32_t              lazyBlksize;
+
+  Line **allocateSet(Addr_t index);
+  Line **getSet(Addr_t index) {
+    if(content)
+      return &content[index];
+    Line **s = lazySet[index >> this->log2Assoc];
+    return s ? s : allocateSet(index);
+  }
 
-  std::map<Addr_t, Tracker> pc2tracker;
+  typedef typename PCTracker<Addr_t>::Tracker Tracker;
+
+  PCTracker<Addr_t> pcTracker;
+  const Tracker     defaultTracker;
+
+  const Tracker &getTracker(Addr_t pc) {
+    const Tracker *t = pcTracker.find(pc);
+    if(t)
+      return *t;
+    trackerMiss->inc();
+    return defaultTracker;
+  }
 
   friend class CacheGeneric<State, Addr_t>;
-  CacheAssoc(int32_t size, int32_t assoc, int32_t blksize, int32_t addrUnit, const char *pStr, bool xr);
+  CacheAssoc(int32_t size, int32_t assoc, int32_t blksize, int32_t addrUnit, const char *pStr, bool xr,
+             uint32_t trackerSize = 1024, bool lazy = false);
 
   void adjustRRIP(Line **theSet, Line **setEnd, Line *change_line, uint16_t next_rrip) {
     if((change_line)->rrip == next_rrip)
@@ -457,16 +614,22 @@ public:
   virtual ~CacheAssoc() {
     delete[] content;
     delete[] mem;
+    for(size_t i = 0; i < lazyChunk.size(); i++)
+      free(lazyChunk[i]);
   }
 
   // TODO: do an iterator. not this junk!!
   Line *getPLine(uint32_t l) {
     // Lines [l..l+assoc] belong to the same set
     I(l < numLines);
-    return content[l];
+    return getSet(l & ~maskAssoc)[l & maskAssoc];
   }
 
   Line *findLine2Replace(Addr_t addr, Addr_t pc, bool prefetch);
+
+  bool isSetIndependent() const {
+    return policy == LRU || policy == LRUp;
+  }
 };
 
 template <class State, class Addr_t> class CacheDM : public CacheGeneric<State, Addr_t> {
@@ -501,6 +664,10 @@ public:
   }
 
   Line *findLine2Replace(Addr_t addr, Addr_t pc, bool prefetch);
+
+  bool isSetIndependent() const {
+    return true;
+  }
 };
 
 template <class State, class Addr_t> class CacheDMSkew : public CacheGeneric<State, Addr_t> {
@@ -660,13 +827,13 @@ public:
 
 template <class Addr_t> class StateGeneric {
 private:
-  Addr_t tag;
-  bool   prefetch; // Line brought for prefetch, not used otherwise
-
+  // Ordered by size, the small fields and the derived states pack at the end
+  Addr_t  tag;
   Addr_t  pc; // For statistic tracking
   Addr_t  sign;
-  uint8_t degree;
   int     nDemand;
+  uint8_t degree;
+  bool    prefetch; // Line brought for prefetch, not used otherwise
 
 public:
   virtual ~StateGeneric() {
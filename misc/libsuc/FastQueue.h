@@ -53,6 +53,11 @@ public:
   bool empty() const {
     return dq.empty();
   }
+  bool full() const {
+    return false;
+  }
+  void grow() {
+  }
 };
 #else
 template <class Data> class FastQueue {
@@ -135,6 +140,24 @@ public:
   bool empty() const {
     return nElems == 0;
   }
+  bool full() const {
+    return nElems > pipeMask;
+  }
+
+  // Doubles the capacity, for queues without a hard size bound
+  void grow() {
+    uint32_t newMask = (pipeMask << 1) | 1;
+    Data *   newPipe = (Data *)malloc(sizeof(Data) * (newMask + 1));
+
+    for(uint32_t i = 0; i < nElems; i++)
+      newPipe[i] = pipe[(start + i) & pipeMask];
+
+    free(pipe);
+    pipe     = newPipe;
+    pipeMask = newMask;
+    start    = 0;
+    end      = nElems & pipeMask;
+  }
 };
 #endif // FASTQUEUE_USE_QUEUE
 
@@ -25,25 +25,36 @@
 
 #include <math.h>
 #include <stdarg.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <strings.h>
 
+#include <algorithm>
+
 #include "GStats.h"
 #include "Report.h"
 #include "SescConf.h"
 
 /*********************** GStats */
 
-GStats::Container GStats::store;
+GStats::Container   GStats::store;
+GStats::NameIndex   GStats::storeIndex;
+pthread_mutex_t     GStats::storeLock = PTHREAD_MUTEX_INITIALIZER;
+int32_t             GStats::nShards   = 1;
+__thread int32_t    GStats::shardId   = 0;
+GStats::ForkBase    GStats::forkBase;
 
 GStats::GStats()
-    : name(NULL) {
+    : storePos(0)
+    , name(NULL)
+    , shards(NULL) {
 }
 
 GStats::~GStats() {
   unsubscribe();
   free(name);
+  free(shards);
 }
 
 char *GStats::getText(const char *format, va_list ap) {
@@ -54,32 +65,99 @@ char *GStats::getText(const char *format, va_list ap) {
   return strdup(strid);
 }
 
+std::string GStats::foldName(const char *str) {
+  std::string key(str);
+  for(size_t i = 0; i < key.size(); i++)
+    key[i] = tolower(key[i]);
+
+  return key;
+}
+
 void GStats::subscribe() {
 
   I(strcmp(getName(), "") != 0);
 
-  if(store.find(getName()) != store.end()) {
+  std::string key = foldName(getName());
+
+  pthread_mutex_lock(&storeLock);
+
+  NameIndex::iterator it = storeIndex.find(key);
+  if(it != storeIndex.end()) {
     MSG("ERROR: gstats is added twice with name [%s]. Use another name", getName());
     I(0);
+    store[it->second] = 0; // Last one registered wins, as it used to
   }
 
-  store[getName()] = this;
+  storePos        = store.size();
+  storeIndex[key] = storePos;
+  store.push_back(this);
+
+  pthread_mutex_unlock(&storeLock);
 }
 
 void GStats::unsubscribe() {
   I(name);
 
-  ContainerIter it = store.find(name);
-  if(it != store.end()) {
-    store.erase(it);
+  pthread_mutex_lock(&storeLock);
+
+  if(storePos < store.size() && store[storePos] == this) {
+    store[storePos] = 0;
+    storeIndex.erase(foldName(name));
+  }
+
+  pthread_mutex_unlock(&storeLock);
+}
+
+int32_t GStats::attachThread() {
+  if(shardId)
+    return shardId;
+
+  int32_t id = AtomicAdd(&nShards, 1);
+  if(id >= MaxShards) {
+    MSG("ERROR: GStats::attachThread too many host threads (max %d)", MaxShards - 1);
+    exit(-1);
+  }
+  shardId = id;
+
+  return id;
+}
+
+GStatsShard *GStats::getShard(int32_t id) {
+  I(id > 0 && id < MaxShards);
+
+  if(unlikely(shards == 0)) {
+    void *ptr = 0;
+    if(posix_memalign(&ptr, sizeof(GStatsShard), sizeof(GStatsShard) * (MaxShards - 1))) {
+      MSG("ERROR: GStats::getShard out of memory for %s", name);
+      exit(-1);
+    }
+    memset(ptr, 0, sizeof(GStatsShard) * (MaxShards - 1));
+
+    // Several threads may race on the first update, only one allocation wins
+    if(AtomicCompareSwap(&shards, static_cast<GStatsShard *>(0), static_cast<GStatsShard *>(ptr)) != 0)
+      free(ptr);
   }
+
+  return &shards[id - 1];
 }
 
 void GStats::report(const char *str) {
   Report::field("#BEGIN GStats::report %s", str);
 
+  pthread_mutex_lock(&storeLock);
+  Container sorted;
+  sorted.reserve(store.size());
   for(ContainerIter it = store.begin(); it != store.end(); it++) {
-    it->second->reportValue();
+    if(*it)
+      sorted.push_back(*it);
+  }
+  pthread_mutex_unlock(&storeLock);
+
+  std::sort(sorted.begin(), sorted.end(),
+            [](const GStats *a, const GStats *b) { return ::strcasecmp(a->getName(), b->getName()) < 0; });
+
+  for(ContainerIter it = sorted.begin(); it != sorted.end(); it++) {
+    (*it)->reportValue();
   }
 
   Report::field("#END GStats::report %s", str);
@@ -90,17 +168,81 @@ void GStats::flushValue() {
 
 void GStats::flush() {
   for(ContainerIter it = store.begin(); it != store.end(); it++) {
-    it->second->flushValue();
+    if(*it)
+      (*it)->flushValue();
   }
 }
 
 GStats *GStats::getRef(const char *str) {
 
-  ContainerIter it = store.find(str);
-  if(it != store.end())
-    return it->second;
+  pthread_mutex_lock(&storeLock);
+
+  GStats *ref = 0;
+
+  NameIndex::iterator it = storeIndex.find(foldName(str));
+  if(it != storeIndex.end())
+    ref = store[it->second];
 
-  return 0;
+  pthread_mutex_unlock(&storeLock);
+
+  return ref;
+}
+
+void GStats::forkSnapshot() {
+  pthread_mutex_lock(&storeLock);
+
+  forkBase.assign(store.size(), std::make_pair(0.0, (int64_t)0));
+  for(size_t i = 0; i < store.size(); i++) {
+    if(store[i])
+      store[i]->getRaw(forkBase[i].first, forkBase[i].second);
+  }
+
+  pthread_mutex_unlock(&storeLock);
+}
+
+bool GStats::forkDump(const char *fname) {
+  FILE *fp = fopen(fname, "w");
+  if(fp == 0)
+    return false;
+
+  pthread_mutex_lock(&storeLock);
+
+  // Stats created after the snapshot start from zero
+  for(size_t i = 0; i < store.size(); i++) {
+    double  v;
+    int64_t n;
+    if(store[i] == 0 || !store[i]->getRaw(v, n))
+      continue;
+
+    double  baseV = i < forkBase.size() ? forkBase[i].first : 0;
+    int64_t baseN = i < forkBase.size() ? forkBase[i].second : 0;
+    if(v == baseV && n == baseN)
+      continue;
+
+    fprintf(fp, "%a %lld %a %lld %s\n", v, (long long)n, baseV, (long long)baseN, store[i]->getName());
+  }
+
+  pthread_mutex_unlock(&storeLock);
+
+  return fclose(fp) == 0;
+}
+
+bool GStats::forkMerge(const char *fname) {
+  FILE *fp = fopen(fname, "r");
+  if(fp == 0)
+    return false;
+
+  double    v, baseV;
+  long long n, baseN;
+  char      str[1024];
+  while(fscanf(fp, "%la %lld %la %lld %1023[^\n]\n", &v, &n, &baseV, &baseN, str) == 5) {
+    GStats *ref = getRef(str);
+    if(ref)
+      ref->mergeRaw(v, n, baseV, baseN);
+  }
+
+  fclose(fp);
+  return true;
 }
 
 /*********************** GStatsCntr */
@@ -124,19 +266,36 @@ GStatsCntr::GStatsCntr(const char *format, ...) {
 }
 
 double GStatsCntr::getDouble() const {
-  return data;
+  double total = data;
+  if(shards) {
+    for(int32_t i = 0; i < MaxShards - 1; i++)
+      total += shards[i].data;
+  }
+  return total;
 }
 
 void GStatsCntr::reportValue() const {
-  Report::field("%s=%f", name, data);
+  Report::field("%s=%f", name, getDouble());
 }
 
 int64_t GStatsCntr::getSamples() const {
-  return (int64_t)data;
+  return (int64_t)getDouble();
 }
 
 void GStatsCntr::flushValue() {
   data = 0;
+  if(shards)
+    memset(shards, 0, sizeof(GStatsShard) * (MaxShards - 1));
+}
+
+bool GStatsCntr::getRaw(double &v, int64_t &n) const {
+  v = getDouble();
+  n = 0;
+  return true;
+}
+
+void GStatsCntr::mergeRaw(double v, int64_t n, double baseV, int64_t baseN) {
+  data += v - baseV;
 }
 
 /*********************** GStatsAvg */
@@ -157,25 +316,74 @@ GStatsAvg::GStatsAvg(const char *format, ...) {
 }
 
 double GStatsAvg::getDouble() const {
-  return ((double)data) / nData;
+  double  total  = data;
+  int64_t nTotal = nData;
+  if(shards) {
+    for(int32_t i = 0; i < MaxShards - 1; i++) {
+      total += shards[i].data;
+      nTotal += shards[i].nData;
+    }
+  }
+  return total / nTotal;
 }
 
 void GStatsAvg::sample(const double v, bool en) {
-  data += en ? v : 0;
-  nData += en ? 1 : 0;
+  if(likely(shardId == 0)) {
+    data += en ? v : 0;
+    nData += en ? 1 : 0;
+    return;
+  }
+
+  GStatsShard *s = getShard(shardId);
+  s->data += en ? v : 0;
+  s->nData += en ? 1 : 0;
+}
+
+void GStatsAvg::sampleMulti(const double total, int64_t n, bool en) {
+  if(likely(shardId == 0)) {
+    data += en ? total : 0;
+    nData += en ? n : 0;
+    return;
+  }
+
+  GStatsShard *s = getShard(shardId);
+  s->data += en ? total : 0;
+  s->nData += en ? n : 0;
 }
 
 void GStatsAvg::reportValue() const {
-  Report::field("%s:n=%lld::v=%f", name, nData, getDouble()); // n first for power
+  Report::field("%s:n=%lld::v=%f", name, getSamples(), getDouble()); // n first for power
 }
 
 int64_t GStatsAvg::getSamples() const {
-  return nData;
+  int64_t nTotal = nData;
+  if(shards) {
+    for(int32_t i = 0; i < MaxShards - 1; i++)
+      nTotal += shards[i].nData;
+  }
+  return nTotal;
 }
 
 void GStatsAvg::flushValue() {
   data  = 0;
   nData = 0;
+  if(shards)
+    memset(shards, 0, sizeof(GStatsShard) * (MaxShards - 1));
+}
+
+bool GStatsAvg::getRaw(double &v, int64_t &n) const {
+  v = data;
+  if(shards) {
+    for(int32_t i = 0; i < MaxShards - 1; i++)
+      v += shards[i].data;
+  }
+  n = getSamples();
+  return true;
+}
+
+void GStatsAvg::mergeRaw(double v, int64_t n, double baseV, int64_t baseN) {
+  data += v - baseV;
+  nData += n - baseN;
 }
 
 /*********************** GStatsMax */
@@ -197,23 +405,58 @@ GStatsMax::GStatsMax(const char *format, ...) {
 }
 
 void GStatsMax::reportValue() const {
-  Report::field("%s:max=%f:n=%lld", name, maxValue, nData);
+  double max = maxValue;
+  if(shards) {
+    for(int32_t i = 0; i < MaxShards - 1; i++)
+      max = shards[i].data > max ? shards[i].data : max;
+  }
+  Report::field("%s:max=%f:n=%lld", name, max, getSamples());
 }
 
 void GStatsMax::sample(const double v, bool en) {
   if(!en)
     return;
-  maxValue = v > maxValue ? v : maxValue;
-  nData++;
+
+  if(likely(shardId == 0)) {
+    maxValue = v > maxValue ? v : maxValue;
+    nData++;
+    return;
+  }
+
+  GStatsShard *s = getShard(shardId);
+  s->data        = v > s->data ? v : s->data;
+  s->nData++;
 }
 
 int64_t GStatsMax::getSamples() const {
-  return nData;
+  int64_t nTotal = nData;
+  if(shards) {
+    for(int32_t i = 0; i < MaxShards - 1; i++)
+      nTotal += shards[i].nData;
+  }
+  return nTotal;
 }
 
 void GStatsMax::flushValue() {
   maxValue = 0;
   nData    = 0;
+  if(shards)
+    memset(shards, 0, sizeof(GStatsShard) * (MaxShards - 1));
+}
+
+bool GStatsMax::getRaw(double &v, int64_t &n) const {
+  v = maxValue;
+  if(shards) {
+    for(int32_t i = 0; i < MaxShards - 1; i++)
+      v = shards[i].data > v ? shards[i].data : v;
+  }
+  n = getSamples();
+  return true;
+}
+
+void GStatsMax::mergeRaw(double v, int64_t n, double baseV, int64_t baseN) {
+  maxValue = v > maxValue ? v : maxValue;
+  nData += n - baseN;
 }
 
 /*********************** GStatsHist */
@@ -43,10 +43,12 @@
 #include "estl.h" // hash_map
 
 #include <list>
+#include <pthread.h>
 #include <stdarg.h>
 #include <vector>
 #include <string>
 
+#include "Snippets.h"
 #include "callback.h"
 #include "nanassert.h"
 
@@ -57,26 +59,70 @@ public:
   }
 };
 
+// Per host thread copy of a statistic. Each shard lives in its own cache
+// line so that cores simulated on different host threads do not false share
+// hot counters. Shards are folded when the value is read (report, getDouble).
+class GStatsShard {
+public:
+  double  data;
+  int64_t nData;
+} __attribute__((aligned(64)));
+
 class GStats {
+public:
+  static const int32_t MaxShards = 16;
+
 private:
-  typedef std::map<std::string, GStats *, GStats_strcasecmp>           Container;
-  typedef Container::iterator ContainerIter;
-  static Container store;
+  // Registration is an append to an unordered vector (plus a hash on the
+  // case-folded name for getRef). Sorting by name happens only at report.
+  typedef std::vector<GStats *>         Container;
+  typedef Container::iterator           ContainerIter;
+  typedef HASH_MAP<std::string, size_t> NameIndex;
+  static Container       store;
+  static NameIndex       storeIndex;
+  static pthread_mutex_t storeLock;
+
+  static int32_t nShards;
+
+  typedef std::vector<std::pair<double, int64_t>> ForkBase;
+  static ForkBase forkBase;
+
+  size_t storePos;
+
+  static std::string foldName(const char *str);
 
 protected:
-  char *name;
+  static __thread int32_t shardId; // 0 for the main simulation thread
+
+  char *       name;
+  GStatsShard *shards; // shards 1..MaxShards-1, allocated on first use
 
-  char *getText(const char *format, va_list ap);
-  void  subscribe();
-  void  unsubscribe();
+  char *       getText(const char *format, va_list ap);
+  void         subscribe();
+  void         unsubscribe();
+  GStatsShard *getShard(int32_t id);
 
 public:
   int32_t gd;
 
   static void report(const char *str);
 
+  // Give the calling host thread its own shard for all the statistics. Must
+  // be called by every extra thread that updates stats (not by the main one).
+  static int32_t attachThread();
+  static int32_t getShardId() {
+    return shardId;
+  }
+
   static GStats *getRef(const char *str);
 
+  // Fork based sampling: a child saves what its statistics gained since
+  // forkSnapshot() to a file, the parent adds it to its own with forkMerge().
+  // Histograms are not merged.
+  static void forkSnapshot();
+  static bool forkDump(const char *fname);
+  static bool forkMerge(const char *fname);
+
   GStats();
   virtual ~GStats();
 
@@ -87,6 +133,14 @@ public:
   virtual void flushValue();
   static void  flush();
 
+  // Folded value and number of samples, false if the class can not be merged
+  virtual bool getRaw(double &v, int64_t &n) const {
+    return false;
+  }
+  // Add what a forked child got on top of (baseV, baseN)
+  virtual void mergeRaw(double v, int64_t n, double baseV, int64_t baseN) {
+  }
+
   virtual double getDouble() const {
     MSG("getDouble Not supported by this class %s", name);
     return 0;
@@ -102,24 +156,30 @@ class GStatsCntr : public GStats {
 private:
   double data;
 
+  double &getData() {
+    if(likely(shardId == 0))
+      return data;
+    return getShard(shardId)->data;
+  }
+
 protected:
 public:
   GStatsCntr(const char *format, ...);
 
   GStatsCntr &operator+=(const double v) {
-    data += v;
+    getData() += v;
     return *this;
   }
 
   void add(const double v, bool en = true) {
-    data += en ? v : 0;
+    getData() += en ? v : 0;
   }
   void inc(bool en = true) {
-    data += en ? 1 : 0;
+    getData() += en ? 1 : 0;
   }
 
   void dec(bool en) {
-    data -= en ? 1 : 0;
+    getData() -= en ? 1 : 0;
   }
 
   double  getDouble() const;
@@ -128,6 +188,9 @@ public:
   void reportValue() const;
 
   void flushValue();
+
+  bool getRaw(double &v, int64_t &n) const;
+  void mergeRaw(double v, int64_t n, double baseV, int64_t baseN);
 };
 
 class GStatsAvg : public GStats {
@@ -142,17 +205,20 @@ public:
   }
 
   void reset() {
-    data  = 0;
-    nData = 0;
+    flushValue();
   };
   double getDouble() const;
 
   virtual void sample(const double v, bool en);
+  void         sampleMulti(const double total, int64_t n, bool en); // n samples adding up to total
   int64_t      getSamples() const;
 
   virtual void reportValue() const;
 
   void flushValue();
+
+  bool getRaw(double &v, int64_t &n) const;
+  void mergeRaw(double v, int64_t n, double baseV, int64_t baseN);
 };
 
 class GStatsMax : public GStats {
@@ -170,8 +236,12 @@ public:
   void reportValue() const;
 
   void flushValue();
+
+  bool getRaw(double &v, int64_t &n) const;
+  void mergeRaw(double v, int64_t n, double baseV, int64_t baseN);
 };
 
+// Histograms are not sharded, update them only from the main thread
 class GStatsHist : public GStats {
 private:
 protected:
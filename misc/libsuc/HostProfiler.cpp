@@ -0,0 +1,84 @@
+/*
+   ESESC: Super ESCalar simulator
+   Copyright (C) 2003 University of Illinois.
+
+This file is part of ESESC.
+
+ESESC is free software; you can redistribute it and/or modify it under the terms
+of the GNU General Public License as published by the Free Software Foundation;
+either version 2, or (at your option) any later version.
+
+ESESC is    distributed in the  hope that  it will  be  useful, but  WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should  have received a copy of  the GNU General  Public License along with
+ESESC; see the file COPYING.  If not, write to the  Free Software Foundation, 59
+Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+*/
+
+#include <pthread.h>
+#include <string.h>
+
+#include "HostProfiler.h"
+#include "Report.h"
+
+bool                        HostProfiler::enabled    = false;
+__thread HostProfiler::ThreadState *HostProfiler::tls = 0;
+HostProfiler::ThreadState * HostProfiler::all        = 0;
+uint64_t                    HostProfiler::startTicks = 0;
+struct timespec             HostProfiler::startTime;
+
+const char *HostProfiler::sectionName[MaxSection] = {"boot", "idle",   "populate", "fetch", "issue",
+                                                     "retire", "mem", "events",   "power", "therm"};
+
+static pthread_mutex_t hostProfMutex = PTHREAD_MUTEX_INITIALIZER;
+
+HostProfiler::ThreadState *HostProfiler::newThreadState() {
+  ThreadState *t = new ThreadState;
+  bzero(t, sizeof(ThreadState));
+
+  pthread_mutex_lock(&hostProfMutex);
+  t->next = all;
+  all     = t;
+  pthread_mutex_unlock(&hostProfMutex);
+
+  tls = t;
+  return t;
+}
+
+void HostProfiler::enable() {
+  clock_gettime(CLOCK_MONOTONIC, &startTime);
+  startTicks = now();
+  enabled    = true;
+}
+
+void HostProfiler::report() {
+  if(!enabled)
+    return;
+
+  // Ticks per second from the elapsed time since enable
+  struct timespec endTime;
+  clock_gettime(CLOCK_MONOTONIC, &endTime);
+  double secs = (endTime.tv_sec - startTime.tv_sec) + (endTime.tv_nsec - startTime.tv_nsec) / 1e9;
+  double tps  = secs > 0 ? (now() - startTicks) / secs : 1;
+
+  uint64_t ticks[MaxSection];
+  uint64_t calls[MaxSection];
+  bzero(ticks, sizeof(ticks));
+  bzero(calls, sizeof(calls));
+
+  pthread_mutex_lock(&hostProfMutex);
+  for(ThreadState *t = all; t; t = t->next) {
+    for(int32_t i = 0; i < MaxSection; i++) {
+      ticks[i] += t->ticks[i];
+      calls[i] += t->calls[i];
+    }
+  }
+  pthread_mutex_unlock(&hostProfMutex);
+
+  for(int32_t i = 0; i < MaxSection; i++) {
+    Report::field("OSSim:hostTime_%s=%.3f", sectionName[i], ticks[i] / tps);
+    Report::field("OSSim:hostCalls_%s=%llu", sectionName[i], (unsigned long long)calls[i]);
+  }
+}
@@ -0,0 +1,133 @@
+/*
+   ESESC: Super ESCalar simulator
+   Copyright (C) 2003 University of Illinois.
+
+This file is part of ESESC.
+
+ESESC is free software; you can redistribute it and/or modify it under the terms
+of the GNU General Public License as published by the Free Software Foundation;
+either version 2, or (at your option) any later version.
+
+ESESC is    distributed in the  hope that  it will  be  useful, but  WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should  have received a copy of  the GNU General  Public License along with
+ESESC; see the file COPYING.  If not, write to the  Free Software Foundation, 59
+Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+*/
+
+#ifndef HOSTPROFILER_H
+#define HOSTPROFILER_H
+
+#include <stdint.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "Snippets.h"
+
+// Host time spent in each simulator subsystem (hostProfile = true in the
+// top conf section). HostProfScope charges the time to its section until
+// the scope ends or a nested scope starts, so the reported times are
+// exclusive and add up to the profiled time of each thread. When disabled a
+// scope costs one predictable branch.
+class HostProfiler {
+public:
+  enum Section {
+    Boot = 0, // TaskHandler::boot loop not covered by another section
+    Idle,     // no core running, waiting for the emulator/sampler
+    Populate, // QEMUReader::populate (the simulation thread feeding from QEMU)
+    Fetch,
+    Issue, // rename + issue
+    Retire,
+    Mem,    // MemObj request handling (MemRequest start/redo)
+    Events, // EventScheduler callbacks not covered by another section
+    Power,  // PowerModel::calcStats
+    Therm,  // SescThermWrapper::calcTemp
+    MaxSection
+  };
+
+  static bool enabled;
+
+private:
+  static const int32_t MaxDepth = 32;
+
+  class ThreadState {
+  public:
+    uint64_t     ticks[MaxSection];
+    uint64_t     calls[MaxSection];
+    int32_t      stack[MaxDepth];
+    int32_t      depth;
+    uint64_t     last;
+    ThreadState *next;
+  };
+
+  static __thread ThreadState *tls;
+  static ThreadState *         all;
+  static uint64_t              startTicks;
+  static struct timespec       startTime;
+
+  static const char *sectionName[MaxSection];
+
+  static ThreadState *newThreadState();
+
+public:
+  static uint64_t now() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+#endif
+  }
+
+  static void enable();
+  static void report();
+
+  static void push(Section s) {
+    ThreadState *t = tls;
+    if(unlikely(t == 0))
+      t = newThreadState();
+
+    uint64_t n = now();
+    if(t->depth > 0 && t->depth <= MaxDepth)
+      t->ticks[t->stack[t->depth - 1]] += n - t->last;
+    if(t->depth < MaxDepth)
+      t->stack[t->depth] = s;
+    t->depth++;
+    t->calls[s]++;
+    t->last = n;
+  }
+
+  static void pop() {
+    ThreadState *t = tls;
+
+    uint64_t n = now();
+    if(t->depth <= MaxDepth)
+      t->ticks[t->stack[t->depth - 1]] += n - t->last;
+    t->depth--;
+    t->last = n;
+  }
+};
+
+class HostProfScope {
+private:
+  const bool on;
+
+public:
+  HostProfScope(HostProfiler::Section s)
+      : on(HostProfiler::enabled) {
+    if(unlikely(on))
+      HostProfiler::push(s);
+  }
+  ~HostProfScope() {
+    if(unlikely(on))
+      HostProfiler::pop();
+  }
+};
+
+#endif
@@ -0,0 +1,182 @@
+/*
+   ESESC: Super ESCalar simulator
+   Copyright (C) 2003 University of Illinois.
+
+This file is part of ESESC.
+
+ESESC is free software; you can redistribute it and/or modify it under the terms
+of the GNU General Public License as published by the Free Software Foundation;
+either version 2, or (at your option) any later version.
+
+ESESC is    distributed in the  hope that  it will  be  useful, but  WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should  have received a copy of  the GNU General  Public License along with
+ESESC; see the file COPYING.  If not, write to the  Free Software Foundation, 59
+Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+*/
+
+#include <stdlib.h>
+#include <sys/mman.h>
+
+#include "PoolArena.h"
+
+pthread_mutex_t PoolArena::mutex      = PTHREAD_MUTEX_INITIALIZER;
+char *          PoolArena::cur        = 0;
+size_t          PoolArena::curLeft    = 0;
+size_t          PoolArena::totalBytes = 0;
+int32_t         PoolArena::hugePages  = -1;
+
+__thread MTPoolCore::Magazine *MTPoolCore::mags[MTPoolCore::MaxPools];
+volatile int32_t               MTPoolCore::nPools = 0;
+
+void PoolArena::setHugePages(bool enable) {
+  hugePages = enable ? 1 : 0;
+}
+
+char *PoolArena::mapChunk(size_t bytes) {
+  if(hugePages < 0)
+    hugePages = getenv("ESESC_HUGEPAGES") ? 1 : 0;
+
+  void *p = MAP_FAILED;
+#ifdef MAP_HUGETLB
+  if(hugePages)
+    p = mmap(0, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+#endif
+  if(p == MAP_FAILED) {
+    p = mmap(0, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if(p == MAP_FAILED) {
+      MSG("ERROR: PoolArena could not map %lu bytes", (unsigned long)bytes);
+      exit(-1);
+    }
+#ifdef MADV_HUGEPAGE
+    if(hugePages)
+      madvise(p, bytes, MADV_HUGEPAGE);
+#endif
+  }
+
+  totalBytes += bytes;
+  return static_cast<char *>(p);
+}
+
+void *PoolArena::alloc(size_t bytes) {
+  bytes = (bytes + 15) & ~static_cast<size_t>(15);
+
+  pthread_mutex_lock(&mutex);
+
+  char *p;
+  if(bytes > ChunkSize / 4) {
+    // Big requests get their own chunk, the current one keeps going
+    p = mapChunk((bytes + ChunkSize - 1) & ~(ChunkSize - 1));
+  } else {
+    if(bytes > curLeft) {
+      cur     = mapChunk(ChunkSize);
+      curLeft = ChunkSize;
+    }
+    p = cur;
+    cur += bytes;
+    curLeft -= bytes;
+  }
+
+  pthread_mutex_unlock(&mutex);
+
+  return p;
+}
+
+MTPoolCore::MTPoolCore(size_t objSize, int32_t ms, ConstructFunc c, void *arg, const char *n)
+    : id(AtomicAdd(&nPools, 1))
+    , blockSize((LinkBytes + objSize + 15) & ~static_cast<size_t>(15))
+    , magSize(ms)
+    , construct(c)
+    , constructArg(arg)
+    , name(n) {
+  I(magSize > 0);
+
+  if(id >= MaxPools) {
+    MSG("ERROR: too many mtpools (%d), increase MTPoolCore::MaxPools", id + 1);
+    exit(-1);
+  }
+
+  depot   = 0;
+  carved  = 0;
+  allMags = 0;
+}
+
+MTPoolCore::Magazine *MTPoolCore::newMagazine() {
+  // Never freed, the blocks of a finished thread stay in its magazine
+  Magazine *m = static_cast<Magazine *>(PoolArena::alloc(sizeof(Magazine)));
+  m->first    = 0;
+  m->n        = 0;
+  m->nOut     = 0;
+  m->nIn      = 0;
+
+  Magazine *c_first;
+  do {
+    c_first    = allMags;
+    m->allNext = c_first;
+  } while(AtomicCompareSwap(&allMags, c_first, m) != c_first);
+
+  mags[id] = m;
+  return m;
+}
+
+void MTPoolCore::refill(Magazine *m) {
+  I(m->first == 0);
+
+  const uint64_t PtrMask = (1ULL << 48) - 1;
+
+  uint64_t top;
+  uint64_t c_top;
+  do {
+    top = depot;
+    if((top & PtrMask) == 0)
+      break;
+    char *   chain = reinterpret_cast<char *>(top & PtrMask);
+    uint64_t next  = reinterpret_cast<uint64_t>(chainLink(chain));
+    c_top          = AtomicCompareSwap(&depot, top, (top & ~PtrMask) + (1ULL << 48) + next);
+    if(c_top == top) {
+      m->first = chain;
+      m->n     = magSize;
+      return;
+    }
+  } while(true);
+
+  // Depot empty, carve a magazine worth of new blocks
+  char *mem = static_cast<char *>(PoolArena::alloc(blockSize * magSize));
+  for(int32_t i = magSize - 1; i >= 0; i--) {
+    char *b = mem + i * blockSize;
+    construct(b + LinkBytes, constructArg);
+    link(b)  = m->first;
+    m->first = b;
+  }
+  m->n = magSize;
+  AtomicAdd(&carved, static_cast<int64_t>(magSize));
+}
+
+void MTPoolCore::flush(Magazine *m) {
+  I(m->n >= magSize);
+
+  const uint64_t PtrMask = (1ULL << 48) - 1;
+
+  char *chain = m->first;
+  char *end   = chain;
+  for(int32_t i = 1; i < magSize; i++)
+    end = link(end);
+  m->first  = link(end);
+  link(end) = 0;
+  m->n -= magSize;
+
+  uint64_t top;
+  do {
+    top              = depot;
+    chainLink(chain) = reinterpret_cast<char *>(top & PtrMask);
+  } while(AtomicCompareSwap(&depot, top, (top & ~PtrMask) + (1ULL << 48) + reinterpret_cast<uint64_t>(chain)) != top);
+}
+
+int64_t MTPoolCore::getLive() const {
+  int64_t live = 0;
+  for(Magazine *m = allMags; m; m = m->allNext)
+    live += static_cast<int64_t>(m->nOut) - static_cast<int64_t>(m->nIn);
+  return live;
+}
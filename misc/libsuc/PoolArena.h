@@ -0,0 +1,150 @@
+/*
+   ESESC: Super ESCalar simulator
+   Copyright (C) 2003 University of Illinois.
+
+This file is part of ESESC.
+
+ESESC is free software; you can redistribute it and/or modify it under the terms
+of the GNU General Public License as published by the Free Software Foundation;
+either version 2, or (at your option) any later version.
+
+ESESC is    distributed in the  hope that  it will  be  useful, but  WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should  have received a copy of  the GNU General  Public License along with
+ESESC; see the file COPYING.  If not, write to the  Free Software Foundation, 59
+Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+*/
+
+#ifndef POOLARENA_H
+#define POOLARENA_H
+
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "Snippets.h"
+#include "nanassert.h"
+
+// Large never-freed memory chunks for the pools. Chunks are 2MB mmaps,
+// backed by huge pages (MAP_HUGETLB) when enabled and available, and
+// marked MADV_HUGEPAGE otherwise. Huge pages default to the ESESC_HUGEPAGES
+// environment variable.
+class PoolArena {
+private:
+  static pthread_mutex_t mutex;
+  static char *          cur;
+  static size_t          curLeft;
+  static size_t          totalBytes;
+  static int32_t         hugePages; // -1 not decided yet
+
+  static char *mapChunk(size_t bytes);
+
+public:
+  static const size_t ChunkSize = 2 * 1024 * 1024;
+
+  static void *alloc(size_t bytes); // 16 byte aligned, thread safe
+
+  static void   setHugePages(bool enable);
+  static size_t getBytes() {
+    return totalBytes;
+  }
+};
+
+// Thread caching core for mtpool. Each block has two link words followed by
+// the object. Every thread keeps a magazine (free list) per pool. When a
+// magazine has 2*magSize free blocks, magSize go to the global depot as a
+// chain. An empty magazine takes a chain from the depot, or carves magSize
+// new blocks from the arena. The depot is a lock-free stack with a tag in the
+// top 16 bits of the pointer (no ABA, blocks are never unmapped).
+class MTPoolCore {
+public:
+  static const int32_t MaxPools = 256;
+  typedef void (*ConstructFunc)(void *obj, void *arg);
+
+private:
+  class Magazine {
+  public:
+    char *    first;
+    int32_t   n;
+    uint64_t  nOut;
+    uint64_t  nIn;
+    Magazine *allNext;
+  };
+
+  static __thread Magazine *mags[MaxPools];
+  static volatile int32_t   nPools;
+
+  static const size_t LinkBytes = 16;
+
+  const int32_t       id;
+  const size_t        blockSize;
+  const int32_t       magSize;
+  const ConstructFunc construct;
+  void *const         constructArg;
+  const char *        name;
+
+  volatile uint64_t depot;
+  volatile int64_t  carved;
+  Magazine *volatile allMags;
+
+  static char *&link(char *b) {
+    return reinterpret_cast<char **>(b)[0];
+  }
+  static char *&chainLink(char *b) {
+    return reinterpret_cast<char **>(b)[1];
+  }
+
+  Magazine *getMagazine() {
+    Magazine *m = mags[id];
+    if(unlikely(m == 0))
+      m = newMagazine();
+    return m;
+  }
+
+  Magazine *newMagazine();
+  void      refill(Magazine *m);
+  void      flush(Magazine *m);
+
+public:
+  MTPoolCore(size_t objSize, int32_t magSize, ConstructFunc c, void *arg, const char *name);
+
+  void *out() {
+    Magazine *m = getMagazine();
+    if(unlikely(m->first == 0))
+      refill(m);
+
+    char *b  = m->first;
+    m->first = link(b);
+    m->n--;
+    m->nOut++;
+
+    return b + LinkBytes;
+  }
+
+  void in(void *obj) {
+    Magazine *m = getMagazine();
+
+    char *b  = static_cast<char *>(obj) - LinkBytes;
+    link(b)  = m->first;
+    m->first = b;
+    m->n++;
+    m->nIn++;
+
+    if(unlikely(m->n >= 2 * magSize))
+      flush(m);
+  }
+
+  // Objects out of the pool (approximate while other threads run)
+  int64_t getLive() const;
+  // Objects ever carved, the peak live count rounded up to magazines
+  int64_t getPeak() const {
+    return carved;
+  }
+  const char *getName() const {
+    return name;
+  }
+};
+
+#endif
@@ -69,6 +69,16 @@ void PortGeneric::destroy() {
   delete this;
 }
 
+Time_t PortGeneric::nextSlots(int32_t nSlots, bool en) {
+  I(nSlots > 0);
+
+  Time_t t = nextSlot(en);
+  for(int32_t i = 1; i < nSlots; i++)
+    nextSlot(en);
+
+  return t;
+}
+
 void PortGeneric::occupyUntil(Time_t u) {
   Time_t t = globalClock;
 
@@ -87,6 +97,12 @@ Time_t PortUnlimited::nextSlot(bool en) {
   return globalClock;
 }
 
+Time_t PortUnlimited::nextSlots(int32_t nSlots, bool en) {
+
+  avgTime.sampleMulti(0, nSlots, en);
+  return globalClock;
+}
+
 void PortUnlimited::occupyUntil(Time_t u) {
 }
 
@@ -110,6 +126,21 @@ Time_t PortFullyPipe::nextSlot(bool en) {
   return lTime++;
 }
 
+Time_t PortFullyPipe::nextSlots(int32_t nSlots, bool en) {
+  I(nSlots > 0);
+
+  if(lTime < globalClock)
+    lTime = globalClock;
+
+  // Slots st, st+1, ... st+nSlots-1
+  Time_t st = lTime;
+  lTime += nSlots;
+
+  double n = nSlots;
+  avgTime.sampleMulti(n * (st - globalClock) + n * (n - 1) / 2, nSlots, en);
+  return st;
+}
+
 Time_t PortFullyPipe::calcNextSlot() const {
   return ((lTime < globalClock) ? globalClock : lTime);
 }
@@ -166,6 +197,21 @@ Time_t PortPipe::nextSlot(bool en) {
   return st;
 }
 
+Time_t PortPipe::nextSlots(int32_t nSlots, bool en) {
+  I(nSlots > 0);
+
+  if(lTime < globalClock)
+    lTime = globalClock;
+
+  // Slots st, st+ocp, ... st+(nSlots-1)*ocp
+  Time_t st = lTime;
+  lTime += static_cast<Time_t>(ocp) * nSlots;
+
+  double n = nSlots;
+  avgTime.sampleMulti(n * (st - globalClock) + ocp * n * (n - 1) / 2, nSlots, en);
+  return st;
+}
+
 Time_t PortPipe::calcNextSlot() const {
   return ((lTime < globalClock) ? globalClock : lTime);
 }
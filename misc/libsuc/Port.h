@@ -77,6 +77,10 @@ public:
   //! Returns when the slot started to be occupied
   virtual Time_t nextSlot(bool en) = 0;
 
+  //! occupy nSlots back to back slots. Same as calling nextSlot nSlots
+  //! times, returns the first slot.
+  virtual Time_t nextSlots(int32_t nSlots, bool en);
+
   //! occupy the port for a number of slots.
   //! Returns the time that the first slot was allocated.
   //!
@@ -102,6 +106,7 @@ public:
 
   void   occupyUntil(Time_t t);
   Time_t nextSlot(bool en);
+  Time_t nextSlots(int32_t nSlots, bool en);
   Time_t calcNextSlot() const;
 };
 
@@ -115,6 +120,7 @@ public:
   PortFullyPipe(const char *name);
 
   Time_t nextSlot(bool en);
+  Time_t nextSlots(int32_t nSlots, bool en);
   Time_t calcNextSlot() const;
 };
 
@@ -142,6 +148,7 @@ public:
   PortPipe(const char *name, TimeDelta_t occ);
 
   Time_t nextSlot(bool en);
+  Time_t nextSlots(int32_t nSlots, bool en);
   Time_t calcNextSlot() const;
 };
 
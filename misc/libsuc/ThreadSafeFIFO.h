@@ -15,6 +15,7 @@ private:
   typedef uint16_t   IndexType;
   volatile IndexType tail;
   volatile IndexType head;
+  IndexType          localTail; // Producer only, see pushLocal
   Type               array[32768];
 
 public:
@@ -37,7 +38,8 @@ public:
 
   ThreadSafeFIFO()
       : tail(0)
-      , head(0) {
+      , head(0)
+      , localTail(0) {
   }
   virtual ~ThreadSafeFIFO() {
   }
@@ -55,6 +57,29 @@ public:
     push();
   };
 
+  // Batched producer side. Elements added with pushLocal become visible to
+  // the consumer every 32 elements or on publish. Do not mix with push.
+  Type *getLocalTailRef() {
+    return &array[localTail];
+  }
+
+  void pushLocal() {
+    localTail = (localTail + 1) & 32767;
+    if((localTail & 31) == 0)
+      publish();
+  }
+
+  void publish() {
+    __sync_synchronize(); // Elements written before the tail moves
+    tail = localTail;
+  }
+
+  bool fullLocal() const {
+    if(((localTail + 2) & 32767) == head)
+      return true;
+    return ((localTail + 1) & 32767) == head;
+  }
+
   bool full() const {
     if(((tail + 2) & 32767) == head)
       return true;
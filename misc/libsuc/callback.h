@@ -1126,6 +1126,69 @@ public:
   }
 };
 
+// Coalesces the schedules of one instance that land on the same cycle: one
+// event per (instance, cycle) that calls memberPtr once per schedule, back
+// to back and in schedule order. The pending cycles map to nSlots slots, a
+// slot busy with another cycle falls back to a CallbackMember0 event.
+template <class ClassType, void (ClassType::*memberPtr)()> class CoalescedCallbackMember0 {
+private:
+  class Slot : public EventScheduler {
+  public:
+    ClassType *instance;
+    Time_t     when;
+    uint32_t   count;
+
+    void call() {
+      uint32_t n = count;
+      count      = 0;
+      for(uint32_t i = 0; i < n; i++)
+        (instance->*memberPtr)();
+    }
+  };
+
+  ClassType *instance;
+  Slot *     slots;
+  uint32_t   slotMask;
+
+public:
+  CoalescedCallbackMember0(ClassType *i, uint32_t nSlots = 256) {
+    instance = i;
+    nSlots   = roundUpPower2(nSlots);
+    slotMask = nSlots - 1;
+    slots    = new Slot[nSlots];
+    for(uint32_t n = 0; n < nSlots; n++) {
+      slots[n].instance = i;
+      slots[n].when     = 0;
+      slots[n].count    = 0;
+    }
+  }
+  ~CoalescedCallbackMember0() {
+    delete[] slots;
+  }
+
+  void schedule(TimeDelta_t delta) {
+    if(delta == 0) {
+      (instance->*memberPtr)();
+      return;
+    }
+
+    Time_t when = globalClock + delta;
+    Slot * s    = &slots[when & slotMask];
+    if(s->count) {
+      if(s->when == when) {
+        s->count++;
+        return;
+      }
+      CallbackMember0<ClassType, memberPtr>::schedule(delta, instance);
+      return;
+    }
+
+    s->when  = when;
+    s->count = 1;
+    EventScheduler::schedule(delta, s);
+  }
+};
+
 /////////////////////////////////////////////////////////////////////////////
 //
 // DESCRIPTION:
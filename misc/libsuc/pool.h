@@ -30,10 +30,13 @@ Temple Place - Suite 330, Boston, MA 02111-1307, USA.
 #include <string.h>
 #include <strings.h>
 
+#include <new>
+
 #include "nanassert.h"
 // Recycle memory allocated from time to time. This is useful for adapting to
 // the phases of the application
 
+#include "PoolArena.h"
 #include "Snippets.h"
 
 #ifdef DEBUG
@@ -301,6 +304,194 @@ public:
   }
 };
 
+// Two sided pool. The owner thread recycles objects with in/out, and a single
+// remote (producer) thread allocates with outRemote. Freed objects go back to
+// the producer in chains of Size elements through a lock-free stack that the
+// producer takes all at once, so no node is ever popped concurrently.
+template <class Ttype> class tsbatchpool {
+protected:
+  class Holder : public Ttype {
+  public:
+    Holder *holderNext; // Next free node
+    Holder *chainNext;  // Next chain in published (only valid in chain heads)
+    ID(bool inPool;)
+  };
+
+  const int32_t Size; // Reproduction and chain size
+  const char *  Name;
+
+  Holder *first; // Owner free list
+  int32_t nFree;
+
+  Holder *remoteFirst;  // Producer free list (current chain)
+  Holder *remoteChains; // Producer chains not started yet
+
+  Holder *volatile published; // Chains handed from the owner to the producer
+
+  Holder *allocChain() {
+    Holder *head = 0;
+    for(int32_t i = 0; i < Size; i++) {
+      Holder *h     = ::new Holder;
+      h->holderNext = head;
+      IS(h->inPool = true);
+      head = h;
+    }
+    return head;
+  }
+
+  void publishChain() {
+    I(nFree >= Size);
+
+    Holder *head = first;
+    Holder *end  = first;
+    for(int32_t i = 1; i < Size; i++)
+      end = end->holderNext;
+
+    first           = end->holderNext;
+    end->holderNext = 0;
+    nFree -= Size;
+
+    Holder *c_first;
+    do {
+      c_first         = published;
+      head->chainNext = c_first;
+    } while(AtomicCompareSwap(&published, c_first, head) != c_first);
+  }
+
+public:
+  tsbatchpool(int32_t s = 32, const char *n = "pool name not declared")
+      : Size(s)
+      , Name(n) {
+    I(Size > 0);
+
+    first        = allocChain();
+    nFree        = Size;
+    remoteFirst  = 0;
+    remoteChains = 0;
+    published    = 0;
+  }
+
+  // Owner thread
+
+  void in(Ttype *data) {
+    Holder *h = static_cast<Holder *>(data);
+
+    I(!h->inPool);
+    IS(h->inPool = true);
+
+    h->holderNext = first;
+    first         = h;
+    nFree++;
+
+    if(nFree >= 2 * Size)
+      publishChain();
+  }
+
+  Ttype *out() {
+    if(first == 0) {
+      first = allocChain();
+      nFree = Size;
+    }
+
+    Holder *h = first;
+    first     = h->holderNext;
+    nFree--;
+
+    I(h->inPool);
+    IS(h->inPool = false);
+
+    return static_cast<Ttype *>(h);
+  }
+
+  // Producer thread
+
+  Ttype *outRemote() {
+    if(remoteFirst == 0) {
+      if(remoteChains == 0)
+        remoteChains = AtomicSwap(&published, static_cast<Holder *>(0));
+
+      if(remoteChains) {
+        // chainNext must be read before the head goes out (the owner may
+        // publish it again)
+        remoteFirst  = remoteChains;
+        remoteChains = remoteChains->chainNext;
+      } else {
+        remoteFirst = allocChain();
+      }
+    }
+
+    Holder *h   = remoteFirst;
+    remoteFirst = h->holderNext;
+
+    I(h->inPool);
+    IS(h->inPool = false);
+
+    return static_cast<Ttype *>(h);
+  }
+};
+
+// Thread caching pools (see MTPoolCore in PoolArena.h). Same out/in API as
+// pool/pool1, but any thread can take or return objects, the objects are
+// carved from large arenas, and live/peak counts are available. Objects are
+// constructed once, when carved.
+template <class Ttype> class mtpool {
+protected:
+  MTPoolCore core;
+
+  static void construct(void *obj, void *) {
+    ::new(obj) Ttype;
+  }
+
+public:
+  mtpool(int32_t s = 32, const char *n = "pool name not declared")
+      : core(sizeof(Ttype), s, construct, 0, n) {
+  }
+
+  Ttype *out() {
+    return static_cast<Ttype *>(core.out());
+  }
+  void in(Ttype *data) {
+    core.in(data);
+  }
+
+  int64_t getLive() const {
+    return core.getLive();
+  }
+  int64_t getPeak() const {
+    return core.getPeak();
+  }
+};
+
+template <class Ttype, class Parameter1> class mtpool1 {
+protected:
+  Parameter1 p1;
+  MTPoolCore core;
+
+  static void construct(void *obj, void *arg) {
+    ::new(obj) Ttype(*static_cast<Parameter1 *>(arg));
+  }
+
+public:
+  mtpool1(Parameter1 a1, int32_t s = 32)
+      : p1(a1)
+      , core(sizeof(Ttype), s, construct, &p1, "pool1") {
+  }
+
+  Ttype *out() {
+    return static_cast<Ttype *>(core.out());
+  }
+  void in(Ttype *data) {
+    core.in(data);
+  }
+
+  int64_t getLive() const {
+    return core.getLive();
+  }
+  int64_t getPeak() const {
+    return core.getPeak();
+  }
+};
+
 template <class Ttype, bool noTimeCheck = false> class pool {
 protected:
   class Holder : public Ttype {
@@ -4,6 +4,7 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <sys/time.h>
 #include <unistd.h>
 
@@ -188,6 +189,165 @@ void tspool_test() {
   fprintf(stderr, "Total = %lld (135510418?)\n", total);
 }
 
+// Same workload as pool_test for any pool with out/in
+template <class PoolType> long long pool_workload(PoolType &pool1, long long &pooled) {
+  std::vector<DummyObjTest *> p(64);
+  p.clear();
+
+  long long total = 0;
+
+  for(int32_t i = 0; i < 612333; i++) {
+    for(char j = 0; j < 12; j++) {
+      DummyObjTest *o = pool1.out();
+      pooled++;
+      o->put(j, j);
+      p.push_back(o);
+    }
+
+    for(char j = 0; j < 12; j++) {
+      DummyObjTest *o = p.back();
+      total += o->get();
+      p.pop_back();
+      pool1.in(o);
+    }
+  }
+
+  for(int32_t i = 0; i < 752333; i++) {
+    for(char j = 0; j < 20; j++) {
+      DummyObjTest *o = pool1.out();
+      pooled++;
+      o->put(j - 7, j);
+      p.push_back(o);
+    }
+
+    for(char j = 0; j < 20; j++) {
+      DummyObjTest *o = p.back();
+      total += o->get();
+      p.pop_back();
+      pool1.in(o);
+    }
+  }
+
+  for(int32_t i = 0; i < 20552333; i++) {
+    DummyObjTest *o = pool1.out();
+    pooled++;
+    o->put(i - 1952333, 2);
+    total += o->get();
+    pool1.in(o);
+  }
+
+  return total;
+}
+
+void mtpool_test() {
+  mtpool<DummyObjTest> pool1(16);
+
+  long long pooled = 0;
+
+  start();
+  long long total = pool_workload(pool1, pooled);
+  finish("Thread Caching", pooled);
+
+  fprintf(stderr, "Total = %lld (135510418?) live=%lld peak=%lld arena=%lluKB\n", total, (long long)pool1.getLive(),
+          (long long)pool1.getPeak(), (unsigned long long)PoolArena::getBytes() / 1024);
+}
+
+mtpool<DummyObjTest> *shared_mtpool;
+
+extern "C" void *mtpool_worker(void *threadargs) {
+  long long *pooled = static_cast<long long *>(threadargs);
+  pool_workload(*shared_mtpool, *pooled);
+  return 0;
+}
+
+void mtpool_threaded_test(int32_t nThreads) {
+  shared_mtpool = new mtpool<DummyObjTest>(16);
+
+  std::vector<pthread_t> th(nThreads);
+  std::vector<long long> pooled(nThreads);
+
+  start();
+  for(int32_t i = 0; i < nThreads; i++) {
+    pooled[i] = 0;
+    pthread_create(&th[i], 0, &mtpool_worker, &pooled[i]);
+  }
+  long long all = 0;
+  for(int32_t i = 0; i < nThreads; i++) {
+    pthread_join(th[i], 0);
+    all += pooled[i];
+  }
+
+  char str[64];
+  sprintf(str, "Thread Caching x%d", nThreads);
+  finish(str, all);
+  fprintf(stderr, "live=%lld peak=%lld\n", (long long)shared_mtpool->getLive(), (long long)shared_mtpool->getPeak());
+}
+
+// Objects taken by a producer thread and returned by the consumer (the DInst
+// flow between QEMU and the simulation thread)
+ThreadSafeFIFO<DummyObjTest *> objfifo;
+
+template <class PoolType> void *cross_producer(PoolType *pool1, int32_t n) {
+  for(int32_t i = 0; i < n; i++) {
+    DummyObjTest *o = pool1->outRemote();
+    o->put(i, 0);
+    while(objfifo.full())
+      ;
+    objfifo.push(&o);
+  }
+  return 0;
+}
+
+// mtpool has no outRemote, any thread can use out
+class MTPoolRemote : public mtpool<DummyObjTest> {
+public:
+  MTPoolRemote()
+      : mtpool<DummyObjTest>(256) {
+  }
+  DummyObjTest *outRemote() {
+    return out();
+  }
+};
+
+tsbatchpool<DummyObjTest> *cross_tsbatchpool;
+MTPoolRemote *             cross_mtpool;
+
+extern "C" void *cross_tsbatch_bootstrap(void *) {
+  return cross_producer(cross_tsbatchpool, 7000000);
+}
+
+extern "C" void *cross_mt_bootstrap(void *) {
+  return cross_producer(cross_mtpool, 7000000);
+}
+
+template <class PoolType> void cross_consumer(PoolType *pool1, int32_t n, const char *str) {
+  for(int32_t i = 0; i < n; i++) {
+    while(objfifo.empty())
+      ;
+    DummyObjTest *o;
+    objfifo.pop(&o);
+    pool1->in(o);
+  }
+  finish(str, n);
+}
+
+void cross_thread_test() {
+  pthread_t th;
+
+  cross_tsbatchpool = new tsbatchpool<DummyObjTest>(256);
+  start();
+  pthread_create(&th, 0, &cross_tsbatch_bootstrap, 0);
+  cross_consumer(cross_tsbatchpool, 7000000, "Cross thread tsbatchpool");
+  pthread_join(th, 0);
+
+  cross_mtpool = new MTPoolRemote;
+  start();
+  pthread_create(&th, 0, &cross_mt_bootstrap, 0);
+  cross_consumer(cross_mtpool, 7000000, "Cross thread mtpool");
+  pthread_join(th, 0);
+  fprintf(stderr, "live=%lld peak=%lld\n", (long long)cross_mtpool->getLive(), (long long)cross_mtpool->getPeak());
+}
+
 ThreadSafeFIFO<DummyObjTest2> tsfifo;
 
 extern "C" void *bootstrap(void *threadargs) {
@@ -244,10 +404,22 @@ void test_tspool_threaded() {
   pthread_kill(qemu_thread, SIGKILL);
 }
 
-int main() {
+int main(int argc, char **argv) {
+
+  // poolBench [nThreads] [-h]   (-h: huge page arenas)
+  int32_t nThreads = 4;
+  for(int i = 1; i < argc; i++) {
+    if(strcmp(argv[i], "-h") == 0)
+      PoolArena::setHugePages(true);
+    else
+      nThreads = atoi(argv[i]);
+  }
 
   tspool_test();
   pool_test();
+  mtpool_test();
+  mtpool_threaded_test(nThreads);
+  cross_thread_test();
   test_tspool_threaded();
 
   return 0;
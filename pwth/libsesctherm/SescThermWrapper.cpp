@@ -42,6 +42,7 @@ Description:    Wrapper class for integration with Esesc / McPat Power Simulatio
 #include <fstream>
 #include <map>
 
+#include "HostProfiler.h"
 #include "SescThermWrapper.h"
 
 class ChipEnergyBundle;
@@ -55,6 +56,8 @@ void SescThermWrapper::plug(const char *section, ChipEnergyBundle *energyBundle)
 
 int SescThermWrapper::calcTemp(ChipEnergyBundle *energyBundle, std::vector<float> *temperatures, uint64_t timeinterval,
                                uint32_t &throttleLength) {
+  HostProfScope prof(HostProfiler::Therm);
+
   int return_signal = 0;
   return_signal     = sesctherm.computeTemp(energyBundle, temperatures, timeinterval);
   throttleLength    = sesctherm.get_throttleLength();
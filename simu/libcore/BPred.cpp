@@ -45,6 +45,7 @@
 #include <fstream>
 
 #include "BPred.h"
+#include "BPredTrace.h"
 #include "IMLIBest.h"
 #include "MemObj.h"
 #include "Report.h"
@@ -1634,6 +1635,8 @@ BPred *BPredictor::getBPred(int32_t id, const char *sec, const char *sname, MemO
     pred = new BPHybrid(id, sec, sname);
   } else if(strcasecmp(type, "yags") == 0) {
     pred = new BPyags(id, sec, sname);
+  } else if(strcasecmp(type, "ogehl") == 0) {
+    pred = new BPOgehl(id, sec, sname);
   } else if(strcasecmp(type, "imli") == 0) {
     pred = new BPIMLI(id, sec, sname);
   } else if(strcasecmp(type, "tdata") == 0) {
@@ -1713,6 +1716,13 @@ BPredictor::BPredictor(int32_t i, MemObj *iobj, MemObj *dobj, BPredictor *bpred)
   SescConf->isInt(bpredSection, "BTACDelay");
   SescConf->isBetween(bpredSection, "BTACDelay", 0, 1024);
 
+  trace = 0;
+  if(SescConf->checkCharPtr(bpredSection, "traceFile")) {
+    char fname[1024];
+    snprintf(fname, sizeof(fname), "%s.%d", SescConf->getCharPtr(bpredSection, "traceFile"), id);
+    trace = new BPredTraceWriter(fname);
+  }
+
   ras = new BPRas(id, bpredSection, "");
 
   // Threads in SMT system share the predictor. Only the Ras is duplicated
@@ -1741,6 +1751,9 @@ BPredictor::BPredictor(int32_t i, MemObj *iobj, MemObj *dobj, BPredictor *bpred)
 
 BPredictor::~BPredictor() {
 
+  if(trace)
+    delete trace;
+
   if(SMTcopy)
     return;
 
@@ -1888,6 +1901,9 @@ TimeDelta_t BPredictor::predict(DInst *dinst, bool *fastfix) {
 
   *fastfix = true;
 
+  if(trace)
+    trace->write(dinst);
+
   PredType outcome1;
   PredType outcome2 = NoPrediction;
   PredType outcome3 = NoPrediction;
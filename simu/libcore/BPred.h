@@ -595,10 +595,14 @@ class BPLdbp : public BPred {
 
 };
 
+class BPredTraceWriter;
+
 class BPredictor {
 private:
   const int32_t id;
   const bool    SMTcopy;
+
+  BPredTraceWriter *trace; // bpredbench trace (traceFile)
   MemObj *      il1; // For prefetch
   MemObj *      dl1; //
 
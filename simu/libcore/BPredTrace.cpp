@@ -0,0 +1,135 @@
+// The ESESC/BSD License
+//
+// Copyright (c) 2005-2013, Regents of the University of California and
+// the ESESC Project.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   - Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+//   - Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in the
+//   documentation and/or other materials provided with the distribution.
+//
+//   - Neither the name of the University of California, Santa Cruz nor the
+//   names of its contributors may be used to endorse or promote products
+//   derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <string.h>
+
+#include "BPredTrace.h"
+#include "Snippets.h"
+
+static const char BPredTraceMagic[8] = {'B', 'P', 'T', 'R', 'A', 'C', 'E', '1'};
+
+BPredTraceWriter::BPredTraceWriter(const char *fname) {
+  fd = fopen(fname, "w");
+  if(fd == 0) {
+    MSG("ERROR: BPredTraceWriter could not create trace file [%s]", fname);
+    exit(-1);
+  }
+  fwrite(BPredTraceMagic, sizeof(BPredTraceMagic), 1, fd);
+
+  lastID = 0;
+}
+
+BPredTraceWriter::~BPredTraceWriter() {
+  fclose(fd);
+}
+
+void BPredTraceWriter::write(const DInst *dinst) {
+  const Instruction *inst = dinst->getInst();
+  I(inst->isControl());
+
+  Time_t delta = lastID ? dinst->getID() - lastID : 1;
+  lastID       = dinst->getID();
+  if(delta > 0xFFFF)
+    delta = 0xFFFF;
+
+  uint8_t rec[36];
+  uint64_t pc     = dinst->getPC();
+  uint64_t target = dinst->isTaken() ? dinst->getAddr() : 0;
+  uint16_t nInst  = delta;
+  uint8_t  opcode = inst->getOpcode();
+  uint8_t  flags  = 0;
+
+  uint64_t ldData = dinst->getData();
+  uint64_t ldPC   = dinst->getLDPC();
+  if(ldPC)
+    flags |= BPredTraceRecord::TraceLdData;
+  if(dinst->isUseLevel3())
+    flags |= BPredTraceRecord::TraceUseLevel3;
+
+  memcpy(&rec[0], &pc, 8);
+  memcpy(&rec[8], &target, 8);
+  memcpy(&rec[16], &nInst, 2);
+  rec[18] = opcode;
+  rec[19] = flags;
+  size_t sz = 20;
+  if(flags & BPredTraceRecord::TraceLdData) {
+    memcpy(&rec[20], &ldData, 8);
+    memcpy(&rec[28], &ldPC, 8);
+    sz = 36;
+  }
+
+  fwrite(rec, sz, 1, fd);
+}
+
+uint64_t BPredTraceReader::load(const char *fname, std::vector<BPredTraceRecord> &trace) {
+  FILE *fd = fopen(fname, "r");
+  if(fd == 0) {
+    MSG("ERROR: BPredTraceReader could not open trace file [%s]", fname);
+    exit(-1);
+  }
+
+  char magic[sizeof(BPredTraceMagic)];
+  if(fread(magic, sizeof(magic), 1, fd) != 1 || memcmp(magic, BPredTraceMagic, sizeof(magic)) != 0) {
+    MSG("ERROR: [%s] is not a branch trace", fname);
+    exit(-1);
+  }
+
+  uint64_t nInst = 0;
+  uint8_t  rec[36];
+  while(fread(rec, 20, 1, fd) == 1) {
+    BPredTraceRecord r;
+    memcpy(&r.pc, &rec[0], 8);
+    memcpy(&r.target, &rec[8], 8);
+    memcpy(&r.nInst, &rec[16], 2);
+    r.opcode = rec[18];
+    r.flags  = rec[19];
+    r.ldData = 0;
+    r.ldPC   = 0;
+    if(r.flags & BPredTraceRecord::TraceLdData) {
+      if(fread(&rec[20], 16, 1, fd) != 1)
+        break; // Truncated trace
+      memcpy(&r.ldData, &rec[20], 8);
+      memcpy(&r.ldPC, &rec[28], 8);
+    }
+    if(r.opcode < iBALU_LBRANCH || r.opcode > iBALU_RET) {
+      MSG("ERROR: [%s] record %lld has a non control opcode %d", fname, (long long)trace.size(), r.opcode);
+      exit(-1);
+    }
+
+    nInst += r.nInst;
+    trace.push_back(r);
+  }
+
+  fclose(fd);
+
+  return nInst;
+}
@@ -0,0 +1,89 @@
+// The ESESC/BSD License
+//
+// Copyright (c) 2005-2013, Regents of the University of California and
+// the ESESC Project.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   - Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+//   - Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in the
+//   documentation and/or other materials provided with the distribution.
+//
+//   - Neither the name of the University of California, Santa Cruz nor the
+//   names of its contributors may be used to endorse or promote products
+//   derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef BPREDTRACE_H
+#define BPREDTRACE_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <vector>
+
+#include "DInst.h"
+
+/*
+ * Branch trace consumed by bpredbench (main/bpredbench.cpp) and written by
+ * BPredictor when the bpred section has traceFile.
+ *
+ * File: 8 byte magic "BPTRACE1" followed by the records. Each record is
+ *   pc(8) target(8) nInst(2) opcode(1) flags(1)
+ * plus ldData(8) ldPC(8) when flags has TraceLdData. target is the taken
+ * address (0 if not taken), nInst the instructions since the previous
+ * record (including this branch).
+ */
+
+class BPredTraceRecord {
+public:
+  enum { TraceLdData = 1, TraceUseLevel3 = 2 };
+
+  uint64_t pc;
+  uint64_t target;
+  uint64_t ldData;
+  uint64_t ldPC;
+  uint16_t nInst;
+  uint8_t  opcode;
+  uint8_t  flags;
+
+  bool isTaken() const {
+    return target != 0;
+  }
+};
+
+class BPredTraceWriter {
+private:
+  FILE * fd;
+  Time_t lastID;
+
+public:
+  BPredTraceWriter(const char *fname);
+  ~BPredTraceWriter();
+
+  void write(const DInst *dinst);
+};
+
+class BPredTraceReader {
+public:
+  // Loads the whole trace. Returns the number of instructions it covers.
+  static uint64_t load(const char *fname, std::vector<BPredTraceRecord> &trace);
+};
+
+#endif
@@ -35,6 +35,8 @@
 // ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
 // POSSIBILITY OF SUCH DAMAGE.
 
+#include <algorithm>
+
 #include "DepWindow.h"
 
 #include "DInst.h"
@@ -45,7 +47,10 @@
 DepWindow::DepWindow(uint32_t cpuid, Cluster *aCluster, const char *clusterName, uint32_t pos)
     : srcCluster(aCluster)
     , Id(cpuid)
-    , wrForwardBus("P(%d)_%s%d_wrForwardBus", cpuid, clusterName, pos) {
+    , wrForwardBus("P(%d)_%s%d_wrForwardBus", cpuid, clusterName, pos)
+    , schedWait("P(%d)_%s%d_schedWait", cpuid, clusterName, pos)
+    , selectPending(false)
+    , selectCB(this) {
   char cadena[1024];
 
   sprintf(cadena, "P(%d)_%s%d_sched", cpuid, clusterName, pos);
@@ -90,7 +95,14 @@ void DepWindow::preSelect(DInst *dinst) {
   dinst->getCluster()->select(dinst);
 }
 
-void DepWindow::select(DInst *dinst) {
+class DepWindowOlder {
+public:
+  bool operator()(const DInst *a, const DInst *b) const {
+    return a->getID() > b->getID();
+  }
+};
+
+void DepWindow::schedule(DInst *dinst) {
 
   Time_t schedTime = schedPort->nextSlot(dinst->getStatsFlag());
   if(dinst->hasInterCluster())
@@ -103,6 +115,42 @@ void DepWindow::select(DInst *dinst) {
   Resource::executingCB::scheduleAbs(schedTime, dinst->getClusterResource(), dinst);
 }
 
+void DepWindow::select(DInst *dinst) {
+
+  if(readyQ.empty() && schedPort->calcNextSlot() <= globalClock) {
+    schedule(dinst);
+    return;
+  }
+
+  // No slot this cycle. Instead of reserving a future slot in wakeup order,
+  // wait in the ready queue and let selectReady pick the oldest first.
+  schedWait.inc(dinst->getStatsFlag());
+  readyQ.push_back(dinst);
+  std::push_heap(readyQ.begin(), readyQ.end(), DepWindowOlder());
+
+  if(!selectPending) {
+    selectPending = true;
+    selectCB.scheduleAbs(std::max(schedPort->calcNextSlot(), globalClock + 1));
+  }
+}
+
+void DepWindow::selectReady() {
+  selectPending = false;
+
+  while(!readyQ.empty() && schedPort->calcNextSlot() <= globalClock) {
+    std::pop_heap(readyQ.begin(), readyQ.end(), DepWindowOlder());
+    DInst *dinst = readyQ.back();
+    readyQ.pop_back();
+
+    schedule(dinst);
+  }
+
+  if(!readyQ.empty()) {
+    selectPending = true;
+    selectCB.scheduleAbs(std::max(schedPort->calcNextSlot(), globalClock + 1));
+  }
+}
+
 // Called when dinst finished execution. Look for dependent to wakeUp
 void DepWindow::executed(DInst *dinst) {
   //  MSG("execute [0x%x] @%lld",dinst, globalClock);
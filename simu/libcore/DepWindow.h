@@ -35,10 +35,13 @@
 #ifndef DEPWINDOW_H
 #define DEPWINDOW_H
 
+#include <vector>
+
 #include "nanassert.h"
 
 #include "Port.h"
 #include "Resource.h"
+#include "callback.h"
 
 class DInst;
 class Cluster;
@@ -53,9 +56,21 @@ private:
   TimeDelta_t SchedDelay;
 
   GStatsCntr wrForwardBus;
+  GStatsCntr schedWait;
 
   PortGeneric *schedPort;
 
+  // Ready instructions that found the sched ports busy in their wakeup cycle.
+  // Min-heap on the DInst ID, so each free slot goes to the oldest one.
+  std::vector<DInst *> readyQ;
+  bool                 selectPending;
+
+  void selectReady();
+  typedef StaticCallbackMember0<DepWindow, &DepWindow::selectReady> selectReadyCB;
+  selectReadyCB selectCB;
+
+  void schedule(DInst *dinst);
+
 protected:
   void preSelect(DInst *dinst);
 
@@ -38,6 +38,7 @@
 #include "GProcessor.h"
 #include "FetchEngine.h"
 #include "GMemorySystem.h"
+#include "HostProfiler.h"
 #include "Report.h"
 #include <sys/time.h>
 #include <unistd.h>
@@ -153,6 +154,8 @@ void GProcessor::buildInstStats(GStatsCntr *i[iMAX], const char *txt) {
 }
 
 int32_t GProcessor::issue(PipeQueue &pipeQ) {
+  HostProfScope prof(HostProfiler::Issue);
+
   int32_t i = 0; // Instructions executed counter
 
   I(!pipeQ.instQueue.empty());
@@ -119,6 +119,7 @@
 #include <assert.h>
 #include <inttypes.h>
 #include <math.h>
+#include <string.h>
 #include <vector>
 
 #include "InstOpcode.h"
@@ -144,10 +145,6 @@
 #endif
 // probably not the best history length, but nice
 
-#ifdef USE_DOLC
-DOLC idolc(MAXHIST, 1, 6, 18);
-#endif
-
 #ifndef STRICTSIZE
 #define PERCWIDTH 6 // Statistical corrector maximum counter width
 #else
@@ -155,124 +152,6 @@ DOLC idolc(MAXHIST, 1, 6, 18);
 #endif
 // The statistical corrector components from CBP4
 
-// global branch GEHL
-#ifdef LARGE_SC
-#define LOGGNB 9
-#else
-#define LOGGNB 10
-#endif
-
-#ifdef IMLI
-#ifdef STRICTSIZE
-#define GNB 2
-int Gm[GNB] = {17, 14};
-#else
-#ifdef LARGE_SC
-#define GNB 4
-int Gm[GNB] = {27, 22, 17, 14};
-#else
-#define GNB 2
-int Gm[GNB] = {17, 14};
-#endif
-#endif
-#else
-#ifdef LARGE_SC
-#define GNB 4
-int Gm[GNB] = {27, 22, 17, 14};
-#else
-#define GNB 2
-int Gm[GNB] = {17, 14};
-#endif
-
-#endif
-/*effective length is  -11,  we use (GHIST<<11)+IMLIcount; we force the IMLIcount zero when IMLI is not used*/
-
-int8_t  GGEHLA[GNB][(1 << LOGGNB)];
-int8_t *GGEHL[GNB];
-
-// large local history
-#define LOGLOCAL 8
-#define NLOCAL (1 << LOGLOCAL)
-#define INDLOCAL (PC & (NLOCAL - 1))
-#ifdef LARGE_SC
-// three different local histories (just completely crazy :-)
-
-#define LOGLNB 10
-#define LNB 3
-int     Lm[LNB] = {11, 6, 3};
-int8_t  LGEHLA[LNB][(1 << LOGLNB)];
-int8_t *LGEHL[LNB];
-#else
-// only one local history
-#define LOGLNB 10
-#define LNB 4
-int     Lm[LNB] = {16, 11, 6, 3};
-int8_t  LGEHLA[LNB][(1 << LOGLNB)];
-int8_t *LGEHL[LNB];
-#endif
-
-// small local history
-#define LOGSECLOCAL 4
-#define NSECLOCAL (1 << LOGSECLOCAL) // Number of second local histories
-#define INDSLOCAL (((PC ^ (PC >> 5))) & (NSECLOCAL - 1))
-#define LOGSNB 9
-#define SNB 4
-int     Sm[SNB] = {16, 11, 6, 3};
-int8_t  SGEHLA[SNB][(1 << LOGSNB)];
-int8_t *SGEHL[SNB];
-
-// third local history
-#define LOGTNB 9
-#ifdef STRICTSIZE
-#define TNB 2
-int Tm[TNB] = {17, 14};
-#else
-#define TNB 3
-int     Tm[TNB] = {22, 17, 14};
-#endif
-// effective local history size +11: we use IMLIcount + (LH) << 11
-int8_t  TGEHLA[TNB][(1 << LOGTNB)];
-int8_t *TGEHL[TNB];
-#define INDTLOCAL (((PC ^ (PC >> 3))) & (NSECLOCAL - 1)) // different hash for the 3rd history
-
-long long L_shist[NLOCAL];
-long long S_slhist[NSECLOCAL];
-long long T_slhist[NSECLOCAL];
-long long HSTACK[16];
-int       pthstack;
-#ifdef LARGE_SC
-// return-stack associated history component
-#ifdef STRICTSIZE
-#define LOGPNB 8
-#else
-#define LOGPNB 9
-#endif
-#define PNB 4
-int     Pm[PNB] = {16, 11, 6, 3};
-int8_t  PGEHLA[PNB][(1 << LOGPNB)];
-int8_t *PGEHL[PNB];
-#else
-// in this case we dont use the call stack
-#define PNB 2
-#define LOGPNB 11
-int Pm[PNB] = {16, 11};
-
-int8_t  PGEHLA[PNB][(1 << LOGPNB)];
-int8_t *PGEHL[PNB];
-#endif
-
-// parameters of the loop predictor
-#define LOGL 6
-#define WIDTHNBITERLOOP 11 // we predict only loops with less than 1K iterations
-#define LOOPTAG 12         // tag width in the loop predictor
-
-// update threshold for the statistical corrector
-#define LOGSIZEUP 0
-int Pupdatethreshold[(1 << LOGSIZEUP)]; // size is fixed by LOGSIZEUP
-#define INDUPD (PC & ((1 << LOGSIZEUP) - 1))
-
-// The three counters used to choose between TAGE ang SC on High Conf TAGE/Low Conf SC
-int8_t FirstH, SecondH, ThirdH;
 #define CONFWIDTH 7   // for the counters in the choser
 #define PHISTWIDTH 27 // width of the path history used in TAGE
 
@@ -691,6 +570,137 @@ public:
   const int  nhist;
   const bool sc;
 
+#ifdef USE_DOLC
+  DOLC idolc;
+#endif
+
+  // Statistical corrector state. It used to be file scope, so all the BPIMLI
+  // instances (one per core) shared and trained the same SC tables.
+
+// global branch GEHL
+#ifdef LARGE_SC
+#define LOGGNB 9
+#else
+#define LOGGNB 10
+#endif
+
+#ifdef IMLI
+#ifdef STRICTSIZE
+#define GNB 2
+int Gm[GNB] = {17, 14};
+#else
+#ifdef LARGE_SC
+#define GNB 4
+int Gm[GNB] = {27, 22, 17, 14};
+#else
+#define GNB 2
+int Gm[GNB] = {17, 14};
+#endif
+#endif
+#else
+#ifdef LARGE_SC
+#define GNB 4
+int Gm[GNB] = {27, 22, 17, 14};
+#else
+#define GNB 2
+int Gm[GNB] = {17, 14};
+#endif
+
+#endif
+/*effective length is  -11,  we use (GHIST<<11)+IMLIcount; we force the IMLIcount zero when IMLI is not used*/
+
+int8_t  GGEHLA[GNB][(1 << LOGGNB)];
+int8_t *GGEHL[GNB];
+
+// large local history
+#define LOGLOCAL 8
+#define NLOCAL (1 << LOGLOCAL)
+#define INDLOCAL (PC & (NLOCAL - 1))
+#ifdef LARGE_SC
+// three different local histories (just completely crazy :-)
+
+#define LOGLNB 10
+#define LNB 3
+int     Lm[LNB] = {11, 6, 3};
+int8_t  LGEHLA[LNB][(1 << LOGLNB)];
+int8_t *LGEHL[LNB];
+#else
+// only one local history
+#define LOGLNB 10
+#define LNB 4
+int     Lm[LNB] = {16, 11, 6, 3};
+int8_t  LGEHLA[LNB][(1 << LOGLNB)];
+int8_t *LGEHL[LNB];
+#endif
+
+// small local history
+#define LOGSECLOCAL 4
+#define NSECLOCAL (1 << LOGSECLOCAL) // Number of second local histories
+#define INDSLOCAL (((PC ^ (PC >> 5))) & (NSECLOCAL - 1))
+#define LOGSNB 9
+#define SNB 4
+int     Sm[SNB] = {16, 11, 6, 3};
+int8_t  SGEHLA[SNB][(1 << LOGSNB)];
+int8_t *SGEHL[SNB];
+
+// third local history
+#define LOGTNB 9
+#ifdef STRICTSIZE
+#define TNB 2
+int Tm[TNB] = {17, 14};
+#else
+#define TNB 3
+int     Tm[TNB] = {22, 17, 14};
+#endif
+// effective local history size +11: we use IMLIcount + (LH) << 11
+int8_t  TGEHLA[TNB][(1 << LOGTNB)];
+int8_t *TGEHL[TNB];
+#define INDTLOCAL (((PC ^ (PC >> 3))) & (NSECLOCAL - 1)) // different hash for the 3rd history
+
+long long L_shist[NLOCAL];
+long long S_slhist[NSECLOCAL];
+long long T_slhist[NSECLOCAL];
+long long HSTACK[16];
+int       pthstack;
+#ifdef LARGE_SC
+// return-stack associated history component
+#ifdef STRICTSIZE
+#define LOGPNB 8
+#else
+#define LOGPNB 9
+#endif
+#define PNB 4
+int     Pm[PNB] = {16, 11, 6, 3};
+int8_t  PGEHLA[PNB][(1 << LOGPNB)];
+int8_t *PGEHL[PNB];
+#else
+// in this case we dont use the call stack
+#define PNB 2
+#define LOGPNB 11
+int Pm[PNB] = {16, 11};
+
+int8_t  PGEHLA[PNB][(1 << LOGPNB)];
+int8_t *PGEHL[PNB];
+#endif
+
+// parameters of the loop predictor
+#define LOGL 6
+#define WIDTHNBITERLOOP 11 // we predict only loops with less than 1K iterations
+#define LOOPTAG 12         // tag width in the loop predictor
+
+// update threshold for the statistical corrector
+#define LOGSIZEUP 0
+int Pupdatethreshold[(1 << LOGSIZEUP)]; // size is fixed by LOGSIZEUP
+#define INDUPD (PC & ((1 << LOGSIZEUP) - 1))
+
+// The three counters used to choose between TAGE ang SC on High Conf TAGE/Low Conf SC
+int8_t FirstH, SecondH, ThirdH;
+
+  // GEHL indices computed by getPrediction and reused by updatePredictor
+  int GGEHLidx[GNB];
+  int LGEHLidx[LNB];
+  int PGEHLidx[PNB];
+
 #ifdef POSTPREDICT
 #define POSTPEXTRA 2
 #define POSTPBITS 5
@@ -744,6 +754,7 @@ public:
   int     Im[INB];
   int8_t  IGEHLA[INB][(1 << LOGINB)];
   int8_t *IGEHL[INB];
+  int     IGEHLidx[INB];
 #endif
 // IMLI-OH related data declaration
 #ifdef IMLIOH
@@ -762,6 +773,7 @@ public:
   int     Fm[FNB];
   int8_t  FGEHLA[FNB][(1 << LOGFNB)];
   int8_t *FGEHL[FNB];
+  int     FGEHLidx[FNB];
 #endif
 #endif
 
@@ -828,7 +840,11 @@ public:
       , log2fetchwidth(_log2fetchwidth)
       , bwidth(_bwidth)
       , nhist(_nhist>=MAXHIST?MAXHIST:_nhist)
-      , sc(_sc) {
+      , sc(_sc)
+#ifdef USE_DOLC
+      , idolc(MAXHIST, 1, 6, 18)
+#endif
+{
 
     ch_i    = new folded_history[nhist + 1];
     ch_t[0] = new folded_history[nhist + 1];
@@ -1011,12 +1027,34 @@ public:
     Seed  = 0;
 
     for(int i = 0; i < HISTBUFFERLENGTH; i++)
-      ghist[0] = 0;
+      ghist[i] = 0;
     ptghist = 0;
 
     for(int i = 0; i < (1 << LOGSIZEUP); i++)
       Pupdatethreshold[i] = 35;
 
+    FirstH    = 0;
+    SecondH   = 0;
+    ThirdH    = 0;
+    IMLIcount = 0;
+    pthstack  = 0;
+
+    memset(GGEHLA, 0, sizeof(GGEHLA));
+    memset(LGEHLA, 0, sizeof(LGEHLA));
+    memset(SGEHLA, 0, sizeof(SGEHLA));
+    memset(TGEHLA, 0, sizeof(TGEHLA));
+    memset(PGEHLA, 0, sizeof(PGEHLA));
+    memset(T_slhist, 0, sizeof(T_slhist));
+    memset(HSTACK, 0, sizeof(HSTACK));
+#ifdef IMLISIC
+    memset(IGEHLA, 0, sizeof(IGEHLA));
+#endif
+#ifdef IMLIOH
+    memset(FGEHLA, 0, sizeof(FGEHLA));
+    memset(PIPE, 0, sizeof(PIPE));
+    memset(ohhisttable, 0, sizeof(ohhisttable));
+#endif
+
     for(int i = 0; i < GNB; i++)
       GGEHL[i] = &GGEHLA[i][0];
     for(int i = 0; i < LNB; i++)
@@ -1494,11 +1532,11 @@ public:
     }
 
     if(IMLIcount >= 2)
-      LSUM += 2 * Gpredict((PC << 2), localoh, Fm, FGEHL, FNB, LOGFNB);
+      LSUM += 2 * Gpredict((PC << 2), localoh, Fm, FGEHL, FNB, LOGFNB, FGEHLidx);
 #endif
 
 #ifdef IMLISIC
-    LSUM += 2 * Gpredict(PC, IMLIcount, Im, IGEHL, INB, LOGINB);
+    LSUM += 2 * Gpredict(PC, IMLIcount, Im, IGEHL, INB, LOGINB, IGEHLidx);
 #else
     long long interIMLIcount = IMLIcount;
     /* just a trick to disable IMLIcount*/
@@ -1510,10 +1548,10 @@ public:
     IMLIcount = 0;
 #endif
 
-    LSUM += Gpredict((PC << 1) + pred_inter /*PC*/, (GHIST << 11) + IMLIcount, Gm, GGEHL, GNB, LOGGNB);
+    LSUM += Gpredict((PC << 1) + pred_inter /*PC*/, (GHIST << 11) + IMLIcount, Gm, GGEHL, GNB, LOGGNB, GGEHLidx);
 
 #ifdef LOCALH
-    LSUM += Gpredict(PC, L_shist[INDLOCAL], Lm, LGEHL, LNB, LOGLNB);
+    LSUM += Gpredict(PC, L_shist[INDLOCAL], Lm, LGEHL, LNB, LOGLNB, LGEHLidx);
 #endif
 #ifdef IMLI
 #ifndef IMLISIC
@@ -1521,7 +1559,7 @@ public:
 #endif
 #endif
 
-    LSUM += Gpredict(PC, GHIST, Pm, PGEHL, PNB, LOGPNB);
+    LSUM += Gpredict(PC, GHIST, Pm, PGEHL, PNB, LOGPNB, PGEHLidx);
 
     bool SCPRED = (LSUM >= 0);
 
@@ -1692,28 +1730,24 @@ public:
 
         ctrupdate(Bias[INDBIAS], resolveDir, PERCWIDTH);
         ctrupdate(BiasSK[INDBIASSK], resolveDir, PERCWIDTH);
-#ifdef IMLI
-#ifndef IMLISIC
-        long long interIMLIcount = IMLIcount;
-        /* just a trick to disable IMLIcount*/
-        IMLIcount = 0;
-#endif
-#endif
-        Gupdate((PC << 1) + pred_inter /*PC*/, resolveDir, (GHIST << 11) + IMLIcount, Gm, GGEHL, GNB, LOGGNB);
+        // Same PC/histories as in getPrediction, reuse the indices
+        Gupdate(resolveDir, GGEHL, GNB, GGEHLidx);
+#ifdef LOCALH
+        Gupdate(resolveDir, LGEHL, LNB, LGEHLidx);
+#else
         Gupdate(PC, resolveDir, L_shist[INDLOCAL], Lm, LGEHL, LNB, LOGLNB);
+#endif
 
-        Gupdate(PC, resolveDir, GHIST, Pm, PGEHL, PNB, LOGPNB);
+        Gupdate(resolveDir, PGEHL, PNB, PGEHLidx);
 
 #ifdef IMLI
 #ifdef IMLISIC
-        Gupdate(PC, resolveDir, IMLIcount, Im, IGEHL, INB, LOGINB);
-#else
-        IMLIcount = interIMLIcount;
+        Gupdate(resolveDir, IGEHL, INB, IGEHLidx);
 #endif
 
 #ifdef IMLIOH
         if(IMLIcount >= 2)
-          Gupdate((PC << 2), resolveDir, localoh, Fm, FGEHL, FNB, LOGFNB);
+          Gupdate(resolveDir, FGEHL, FNB, FGEHLidx);
 #endif
 
 #endif
@@ -1906,16 +1940,26 @@ public:
    (bhist >> (40 - 4 * i))) &                                                                                                   \
       ((1 << (logs - (i >= (NBR - 2)))) - 1)
 
-  int Gpredict(AddrType PC, long long BHIST, int *length, int8_t **tab, int NBR, int logs) {
+  // The index hashes do not depend on the tables, compute them all first (the
+  // compiler can vectorize the loop) and then gather the counters
+  int Gpredict(AddrType PC, long long BHIST, int *length, int8_t **tab, int NBR, int logs, int *idx) {
 
-    int PERCSUM = 0;
     for(int i = 0; i < NBR; i++) {
       long long bhist = BHIST & ((long long)((1 << length[i]) - 1));
-      int16_t   ctr   = tab[i][GINDEX];
-      PERCSUM += (2 * ctr + 1);
+      idx[i]          = GINDEX;
     }
 
-    return PERCSUM;
+    int sum = 0;
+    for(int i = 0; i < NBR; i++)
+      sum += tab[i][idx[i]];
+
+    return 2 * sum + NBR; // sum of (2 * ctr + 1)
+  }
+
+  void Gupdate(bool taken, int8_t **tab, int NBR, const int *idx) {
+
+    for(int i = 0; i < NBR; i++)
+      ctrupdate(tab[i][idx[i]], taken, PERCWIDTH - (i < (NBR - 1)));
   }
 
   void Gupdate(AddrType PC, bool taken, long long BHIST, int *length, int8_t **tab, int NBR, int logs) {
@@ -41,6 +41,7 @@
 #include "ClusterManager.h"
 #include "FetchEngine.h"
 #include "GMemorySystem.h"
+#include "HostProfiler.h"
 #include "InOrderProcessor.h"
 #include "TaskHandler.h"
 #include "estl.h"
@@ -116,6 +117,8 @@ bool SMTFetch::update(bool space) {
 } // 1}}}
 
 void InOrderProcessor::fetch(FlowID fid) { /*{{{*/
+  HostProfScope prof(HostProfiler::Fetch);
+
   // TODO: Move this to GProcessor (same as in OoOProcessor)
   I(eint);
   I(active);
@@ -319,6 +322,7 @@ return NoStall;
 } /*}}}*/
 
 void InOrderProcessor::retire() { /*{{{*/
+  HostProfScope prof(HostProfiler::Retire);
 
   // Pass all the ready instructions to the rrob
   bool stats = false;
@@ -25,10 +25,74 @@ Temple Place - Suite 330, Boston, MA 02111-1307, USA.
 #include "SescConf.h"
 /* }}} */
 
+LSQAddrIndex::LSQAddrIndex(int32_t size)
+    /* constructor {{{1 */
+    : freeList(None) {
+  // maxLSQ defaults to 32K (unlimited), no need to preallocate all of it
+  size_t nEntries = size < 1024 ? (size < 16 ? 16 : size) : 1024;
+
+  buckets.resize(roundUpPower2(nEntries) * 2, None);
+  bucketMask = buckets.size() - 1;
+
+  grow(nEntries);
+}
+/* }}} */
+
+void LSQAddrIndex::grow(size_t nEntries)
+/* add nEntries to the free list {{{1 */
+{
+  size_t old = entries.size();
+  entries.resize(old + nEntries);
+  for(size_t i = old; i < entries.size(); i++) {
+    entries[i].next = freeList;
+    freeList        = i;
+  }
+}
+/* }}} */
+
+void LSQAddrIndex::insert(AddrType word, DInst *dinst)
+/* insert {{{1 */
+{
+  if(unlikely(freeList == None))
+    grow(entries.size());
+
+  int32_t pos = freeList;
+  Entry & e   = entries[pos];
+  freeList    = e.next;
+
+  int32_t b  = getBucket(word);
+  e.word     = word;
+  e.dinst    = dinst;
+  e.id       = dinst->getID();
+  e.next     = buckets[b];
+  buckets[b] = pos;
+}
+/* }}} */
+
+bool LSQAddrIndex::remove(AddrType word, DInst *dinst)
+/* remove, false if not found {{{1 */
+{
+  int32_t *link = &buckets[getBucket(word)];
+  while(*link != None) {
+    Entry &e = entries[*link];
+    if(e.dinst == dinst) {
+      int32_t pos = *link;
+      *link       = e.next;
+      e.next      = freeList;
+      freeList    = pos;
+      return true;
+    }
+    link = &e.next;
+  }
+  return false;
+}
+/* }}} */
+
 LSQFull::LSQFull(const int32_t id, int32_t size)
     /* constructor {{{1 */
     : LSQ(size)
-    , stldForwarding("P(%d):stldForwarding", id) {
+    , stldForwarding("P(%d):stldForwarding", id)
+    , instMap(size) {
 }
 /* }}} */
 
@@ -36,7 +100,7 @@ bool LSQFull::insert(DInst *dinst)
 /* Insert dinst in LSQ (in-order) {{{1 */
 {
   I(dinst->getAddr());
-  instMap.insert(std::pair<AddrType, DInst *>(calcWord(dinst), dinst));
+  instMap.insert(calcWord(dinst), dinst);
 
   return true;
 }
@@ -48,37 +112,24 @@ DInst *LSQFull::executing(DInst *dinst)
   I(dinst->getAddr());
 
   AddrType tag = calcWord(dinst);
+  Time_t   id  = dinst->getID();
 
   const Instruction *inst   = dinst->getInst();
   DInst *            faulty = 0;
 
-#if 0
-  AddrDInstQMap::const_iterator instIt = instMap.begin();
-  I(instIt != instMap.end());
-
-  I(!dinst->isExecuted());
-
-  while(instIt != instMap.end()) {
-    if (instIt->first != tag){
-      instIt++;
+  for(int32_t pos = instMap.head(tag); pos != LSQAddrIndex::None; pos = instMap.getNext(pos)) {
+    if(instMap.getWord(pos) != tag)
       continue;
-    }
-#endif
-  std::pair<AddrDInstQMap::iterator, AddrDInstQMap::iterator> ret;
-  ret = instMap.equal_range(tag);
-  for(AddrDInstQMap::iterator instIt = ret.first; instIt != ret.second; ++instIt) {
-    I(instIt->first == tag);
 
     // inst->dump("Executed");
-    DInst *qdinst = instIt->second;
+    DInst *qdinst = instMap.getDInst(pos);
     if(qdinst == dinst) {
       continue;
     }
 
     const Instruction *qinst = qdinst->getInst();
 
-    // bool beforeInst = qdinst->getID() < dinst->getID();
-    bool oooExecuted = qdinst->getID() > dinst->getID();
+    bool oooExecuted = instMap.getID(pos) > id;
     if(oooExecuted) {
 
       if(qdinst->isExecuted() && qdinst->getPC() != dinst->getPC()) {
@@ -109,20 +160,7 @@ void LSQFull::remove(DInst *dinst)
 {
   I(dinst->getAddr());
 
-  // const Instruction *inst = dinst->getInst();
-
-  std::pair<AddrDInstQMap::iterator, AddrDInstQMap::iterator> rangeIt;
-  // rangeIt = instMap.equal_range(calcWord(dinst));
-  AddrDInstQMap::iterator instIt = instMap.begin();
-
-  // for(AddrDInstQMap::iterator it = rangeIt.first; it != rangeIt.second ; it++) {
-  while(instIt != instMap.end()) {
-    if(instIt->second == dinst) {
-      instMap.erase(instIt);
-      return;
-    }
-    instIt++;
-  }
+  instMap.remove(calcWord(dinst), dinst);
 }
 /* }}} */
 
@@ -169,6 +207,7 @@ void LSQNone::remove(DInst *dinst)
 LSQVPC::LSQVPC(int32_t size)
     /* constructor {{{1 */
     : LSQ(size)
+    , instMap(size)
     , LSQVPC_replays("LSQVPC_replays") {
 }
 /* }}} */
@@ -177,7 +216,7 @@ bool LSQVPC::insert(DInst *dinst)
 /* Insert dinst in LSQ (in-order) {{{1 */
 {
   I(dinst->getAddr());
-  instMap.insert(std::pair<AddrType, DInst *>(calcWord(dinst), dinst));
+  instMap.insert(calcWord(dinst), dinst);
 
   return true;
 }
@@ -192,31 +231,18 @@ DInst *LSQVPC::executing(DInst *dinst) {
 AddrType LSQVPC::replayCheck(DInst *dinst) // return non-zero if replay needed
 /* dinst got executed (out-of-order) {{{1 */
 {
-  AddrType                                   tag = calcWord(dinst);
-  std::multimap<AddrType, DInst *>::iterator instIt;
-  // instIt = instMap.begin();
-  instIt = instMap.find(tag);
-  // AddrType storefound = 0;
-  // while(instIt != instMap.end()){
-  while(instIt->first == tag) {
-    if(instIt->first != tag) {
-      instIt++;
+  AddrType tag = calcWord(dinst);
+  Time_t   id  = dinst->getID();
+
+  for(int32_t pos = instMap.head(tag); pos != LSQAddrIndex::None; pos = instMap.getNext(pos)) {
+    if(instMap.getWord(pos) != tag)
       continue;
+    if(instMap.getID(pos) < id && instMap.getDInst(pos)->getAddr() == dinst->getAddr()) {
+      LSQVPC_replays.inc(dinst->getStatsFlag());
+      return 1;
     }
-    if(instIt->second->getID() < dinst->getID()) {
-      if(instIt->second->getAddr() == dinst->getAddr()) {
-        LSQVPC_replays.inc(dinst->getStatsFlag());
-        return 1;
-      }
-    }
-    // storefound = instIt->second->getPC();
-    // if(instIt->second->getData()==dinst->getData()){
-    //  return 0; //no replay needed
-    //}
-    instIt++;
   }
   return 0;
-  // return storefound;
 }
 /* }}} */
 
@@ -224,18 +250,6 @@ void LSQVPC::remove(DInst *dinst)
 /* Remove from the LSQ {{{1 (in-order) */
 {
   I(dinst->getAddr());
-  std::multimap<AddrType, DInst *>::iterator instIt;
-  // instIt = instMap.begin();
-  AddrType tag = calcWord(dinst);
-  instIt       = instMap.find(tag);
-  // while(instIt != instMap.end()){
-  while(instIt->first == tag) {
-    if(instIt->second == dinst) {
-      instMap.erase(instIt);
-      return;
-    }
-    instIt++;
-    if(instIt == instMap.end())
-      return;
-  }
+  instMap.remove(calcWord(dinst), dinst);
 }
+/* }}} */
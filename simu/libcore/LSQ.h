@@ -65,12 +65,62 @@ public:
   }
 };
 
-class LSQFull : public LSQ {
+// Address bucketed table of the in-flight memory instructions. Entries live
+// in a preallocated array chained per bucket, so insert/lookup/remove do not
+// allocate. It only grows (doubling) if the LSQ holds more entries than the
+// configured size, which should not happen in steady state.
+class LSQAddrIndex {
+public:
+  static const int32_t None = -1;
+
 private:
-  typedef HASH_MULTIMAP<AddrType, DInst *> AddrDInstQMap;
+  class Entry {
+  public:
+    AddrType word;
+    DInst *  dinst;
+    Time_t   id; // ROB age, cached to avoid touching the DInst
+    int32_t  next;
+  };
+
+  std::vector<Entry>   entries;
+  std::vector<int32_t> buckets;
+  int32_t              freeList;
+  AddrType             bucketMask;
+
+  int32_t getBucket(AddrType word) const {
+    return (word ^ (word >> 13)) & bucketMask;
+  }
+
+  void grow(size_t nEntries);
 
-  GStatsCntr    stldForwarding;
-  AddrDInstQMap instMap;
+public:
+  LSQAddrIndex(int32_t size);
+
+  void insert(AddrType word, DInst *dinst);
+  bool remove(AddrType word, DInst *dinst);
+
+  // Walk the chain that may contain word (other words can share the bucket)
+  int32_t head(AddrType word) const {
+    return buckets[getBucket(word)];
+  }
+  int32_t getNext(int32_t pos) const {
+    return entries[pos].next;
+  }
+  AddrType getWord(int32_t pos) const {
+    return entries[pos].word;
+  }
+  DInst *getDInst(int32_t pos) const {
+    return entries[pos].dinst;
+  }
+  Time_t getID(int32_t pos) const {
+    return entries[pos].id;
+  }
+};
+
+class LSQFull : public LSQ {
+private:
+  GStatsCntr   stldForwarding;
+  LSQAddrIndex instMap;
 
   static AddrType calcWord(const DInst *dinst) {
     return (dinst->getAddr()) >> 3;
@@ -106,7 +156,7 @@ public:
 
 class LSQVPC : public LSQ {
 private:
-  std::multimap<AddrType, DInst *> instMap;
+  LSQAddrIndex instMap;
 
   GStatsCntr LSQVPC_replays;
 
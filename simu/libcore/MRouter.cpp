@@ -47,12 +47,22 @@ MRouter::MRouter(MemObj *obj)
   down_node.clear();
   up_node.clear();
   // down_mobj = 0;
+
+  batch = new MemRequestBatch();
 }
 /* }}} */
 
 MRouter::~MRouter()
 /* destructor {{{1 */
 {
+  delete batch;
+}
+/* }}} */
+
+void MRouter::enableBatch(uint32_t nSlots)
+/* one event per cycle for the requests this node sends {{{1 */
+{
+  batch->setSlots(nSlots);
 }
 /* }}} */
 
@@ -196,7 +206,7 @@ void MRouter::scheduleReqPos(uint32_t pos, MemRequest *mreq, TimeDelta_t lat)
 /* schedule req down {{{1 */
 {
   I(down_node.size() > pos);
-  mreq->startReq(down_node[pos], lat);
+  batch->startReq(mreq, down_node[pos], lat);
 }
 /* }}} */
 
@@ -204,7 +214,7 @@ void MRouter::scheduleReq(MemRequest *mreq, TimeDelta_t lat)
 /* schedule req down {{{1 */
 {
   I(down_node.size() == 1);
-  mreq->startReq(down_node[0], lat);
+  batch->startReq(mreq, down_node[0], lat);
 }
 /* }}} */
 
@@ -220,7 +230,7 @@ void MRouter::scheduleReqAck(MemRequest *mreq, TimeDelta_t lat)
     obj = it->second;
   }
 
-  mreq->startReqAck(obj, lat);
+  batch->startReqAck(mreq, obj, lat);
 }
 /* }}} */
 
@@ -235,7 +245,7 @@ void MRouter::scheduleReqAckAbs(MemRequest *mreq, Time_t w)
     obj = it->second;
   }
   obj->blockFill(mreq);
-  mreq->startReqAckAbs(obj, w);
+  batch->startReqAckAbs(mreq, obj, w);
 }
 /* }}} */
 
@@ -245,7 +255,7 @@ void MRouter::scheduleReqAckPos(uint32_t pos, MemRequest *mreq, TimeDelta_t lat)
   I(!up_node.empty());
   I(pos < up_node.size());
 
-  mreq->startReqAck(up_node[pos], lat);
+  batch->startReqAck(mreq, up_node[pos], lat);
 }
 /* }}} */
 
@@ -255,7 +265,7 @@ void MRouter::scheduleSetStatePos(uint32_t pos, MemRequest *mreq, TimeDelta_t la
   I(!up_node.empty());
   I(pos < up_node.size());
 
-  mreq->startSetState(up_node[pos], lat);
+  batch->startSetState(mreq, up_node[pos], lat);
 }
 /* }}} */
 
@@ -264,7 +274,7 @@ void MRouter::scheduleSetStateAck(MemRequest *mreq, TimeDelta_t lat)
 {
   I(down_node.size() == 1);
 
-  mreq->startSetStateAck(down_node[0], lat);
+  batch->startSetStateAck(mreq, down_node[0], lat);
 }
 /* }}} */
 
@@ -273,7 +283,7 @@ void MRouter::scheduleSetStateAckPos(uint32_t pos, MemRequest *mreq, TimeDelta_t
 {
   I(down_node.size() > pos);
 
-  mreq->startSetStateAck(down_node[pos], lat);
+  batch->startSetStateAck(mreq, down_node[pos], lat);
 }
 /* }}} */
 
@@ -281,7 +291,7 @@ void MRouter::scheduleDispPos(uint32_t pos, MemRequest *mreq, TimeDelta_t lat)
 /* schedule Displace (down) {{{1 */
 {
   I(down_node.size() > pos);
-  mreq->startDisp(down_node[pos], lat);
+  batch->startDisp(mreq, down_node[pos], lat);
 }
 /* }}} */
 
@@ -289,7 +299,7 @@ void MRouter::scheduleDisp(MemRequest *mreq, TimeDelta_t lat)
 /* schedule Displace (down) {{{1 */
 {
   I(down_node.size() == 1);
-  mreq->startDisp(down_node[0], lat);
+  batch->startDisp(mreq, down_node[0], lat);
 }
 /* }}} */
 
@@ -335,7 +345,7 @@ int32_t MRouter::sendSetStateOthers(MemRequest *mreq, MsgAction ma, TimeDelta_t
     MemRequest *breq = MemRequest::createSetState(self_mobj, mreq->getCreator(), ma, addr, doStats);
     breq->addPendingSetStateAck(mreq);
 
-    breq->startSetState(up_node[i], lat);
+    batch->startSetState(breq, up_node[i], lat);
     conta++;
   }
 
@@ -359,7 +369,7 @@ int32_t MRouter::sendSetStateOthersPos(uint32_t pos, MemRequest *mreq, MsgAction
   MemRequest *breq = MemRequest::createSetState(self_mobj, mreq->getCreator(), ma, addr, doStats);
   breq->addPendingSetStateAck(mreq);
 
-  breq->startSetState(up_node[pos], lat);
+  batch->startSetState(breq, up_node[pos], lat);
 
   return 1;
 }
@@ -383,7 +393,33 @@ int32_t MRouter::sendSetStateAll(MemRequest *mreq, MsgAction ma, TimeDelta_t lat
     MemRequest *breq = MemRequest::createSetState(self_mobj, mreq->getCreator(), ma, addr, doStats);
     breq->addPendingSetStateAck(mreq);
 
-    breq->startSetState(up_node[i], lat);
+    batch->startSetState(breq, up_node[i], lat);
+    conta++;
+  }
+
+  return conta;
+}
+/* }}} */
+
+int32_t MRouter::sendSetStateMask(uint64_t mask, int16_t skip, MemRequest *mreq, MsgAction ma, TimeDelta_t lat)
+/* send setState to the up node positions set in mask but skip, return how many {{{1 */
+{
+  bool     doStats = mreq->getStatsFlag();
+  AddrType addr    = mreq->getAddr();
+
+  if(skip >= 0 && skip < 64)
+    mask &= ~(1ULL << skip);
+
+  int32_t conta = 0;
+  while(mask) {
+    int16_t pos = __builtin_ctzll(mask);
+    mask &= mask - 1;
+    I((size_t)pos < up_node.size());
+
+    MemRequest *breq = MemRequest::createSetState(self_mobj, mreq->getCreator(), ma, addr, doStats);
+    breq->addPendingSetStateAck(mreq);
+
+    batch->startSetState(breq, up_node[pos], lat);
     conta++;
   }
 
@@ -437,6 +473,25 @@ TimeDelta_t MRouter::ffwritePos(uint32_t pos, AddrType addr)
 }
 /* }}} */
 
+void MRouter::ffbatch(const MemWarmupOp *ops, size_t n)
+/* propagate the warmup batch to the lower level {{{1 */
+{
+  if(n == 0 || down_node.empty())
+    return;
+  down_node[0]->ffbatch(ops, n);
+}
+/* }}} */
+
+void MRouter::ffbatchPos(uint32_t pos, const MemWarmupOp *ops, size_t n)
+/* propagate the warmup batch to the lower level {{{1 */
+{
+  I(pos < down_node.size());
+  if(n == 0)
+    return;
+  down_node[pos]->ffbatch(ops, n);
+}
+/* }}} */
+
 bool MRouter::isBusyPos(uint32_t pos, AddrType addr) const
 /* propagate the isBusy {{{1 */
 {
@@ -47,7 +47,9 @@
 /* }}} */
 
 class MemObj;
+struct MemWarmupOp;
 class MemRequest;
+class MemRequestBatch;
 
 // MsgAction enumerate {{{1
 //
@@ -88,6 +90,8 @@ protected:
   std::vector<MemObj *> up_node;
   std::vector<MemObj *> down_node;
 
+  MemRequestBatch *batch; // disabled unless enableBatch
+
   void updateRouteTables(MemObj *upmobj, MemObj *const top_node);
 
 public:
@@ -97,6 +101,7 @@ public:
   int16_t getCreatorPort(const MemRequest *mreq) const;
 
   void fillRouteTables();
+  void enableBatch(uint32_t nSlots);
   void addUpNode(MemObj *upm);
   void addDownNode(MemObj *upm);
 
@@ -119,6 +124,7 @@ public:
   int32_t sendSetStateOthers(MemRequest *mreq, MsgAction ma, TimeDelta_t lat = 0);
   int32_t sendSetStateOthersPos(uint32_t pos, MemRequest *mreq, MsgAction ma, TimeDelta_t lat = 0);
   int32_t sendSetStateAll(MemRequest *mreq, MsgAction ma, TimeDelta_t lat = 0);
+  int32_t sendSetStateMask(uint64_t mask, int16_t skip, MemRequest *mreq, MsgAction ma, TimeDelta_t lat = 0);
 
   void tryPrefetch(AddrType addr, bool doStats, int degree, AddrType pref_sign, AddrType pc, CallbackBase *cb = 0);
   void tryPrefetchPos(uint32_t pos, AddrType addr, int degree, bool doStats, AddrType pref_sign, AddrType pc, CallbackBase *cb = 0);
@@ -127,12 +133,17 @@ public:
   TimeDelta_t ffwrite(AddrType addr);
   TimeDelta_t ffreadPos(uint32_t pos, AddrType addr);
   TimeDelta_t ffwritePos(uint32_t pos, AddrType addr);
+  void        ffbatch(const MemWarmupOp *ops, size_t n);
+  void        ffbatchPos(uint32_t pos, const MemWarmupOp *ops, size_t n);
 
   bool isBusyPos(uint32_t pos, AddrType addr) const;
 
   bool isTopLevel() const {
     return up_node.empty();
   }
+  size_t getnUpNodes() const {
+    return up_node.size();
+  }
 
   MemObj *getDownNode(int pos = 0) const {
     I(down_node.size() > pos);
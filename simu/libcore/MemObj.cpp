@@ -121,6 +121,18 @@ void MemObj::blockFill(MemRequest *mreq) {
   // Most objects do nothing
 }
 
+void MemObj::ffbatch(const MemWarmupOp *ops, size_t n)
+/* batched fast forward, one access at a time by default {{{1 */
+{
+  for(size_t i = 0; i < n; i++) {
+    if(ops[i].write)
+      ffwrite(ops[i].addr);
+    else
+      ffread(ops[i].addr);
+  }
+}
+/* }}} */
+
 #if 0
 void MemObj::tryPrefetch(AddrType addr, bool doStats, int degree, AddrType pref_sign, AddrType pc, CallbackBase *cb)
   /* forward tryPrefetch {{{1 */
@@ -920,6 +932,13 @@ TimeDelta_t DummyMemObj::ffwrite(AddrType addr)
 }
 /* }}} */
 
+void DummyMemObj::ffbatch(const MemWarmupOp *ops, size_t n)
+/* batched fast forward {{{1 */
+{
+  // Nothing to warm
+}
+/* }}} */
+
 void DummyMemObj::tryPrefetch(AddrType addr, bool doStats, int degree, AddrType pref_sign, AddrType pc, CallbackBase *cb)
 /* forward tryPrefetch {{{1 */
 {
@@ -48,6 +48,14 @@
 
 class MemRequest;
 
+// One access of a batched fast forward warmup (see MemObj::ffbatch)
+struct MemWarmupOp {
+  AddrType addr;
+  AddrType pc;
+  bool     write;
+};
+typedef std::vector<MemWarmupOp> MemWarmupBatch;
+
 #define PSIGN_NONE 0
 #define PSIGN_RAS 1
 #define PSIGN_NLINE 2
@@ -56,6 +64,7 @@ class MemRequest;
 #define PSIGN_INDIRECT 5
 #define PSIGN_CHASE 6
 #define PSIGN_MEGA 7
+#define PSIGN_MAX 8
 #define LDBUFF_SIZE 512
 #define CIR_QUEUE_WINDOW 512 //FIXME: need to change this to a conf variable
 
@@ -562,6 +571,9 @@ public:
   // Interface for fast-forward (no BW, just warmup caches)
   virtual TimeDelta_t ffread(AddrType addr)  = 0;
   virtual TimeDelta_t ffwrite(AddrType addr) = 0;
+  // Batched ffread/ffwrite. Each level processes the whole batch and sends the
+  // accesses that must reach the next level as a single batch.
+  virtual void ffbatch(const MemWarmupOp *ops, size_t n);
 
   // DOWN
   virtual void req(MemRequest *req)         = 0;
@@ -635,6 +647,7 @@ public:
 
   TimeDelta_t ffread(AddrType addr);
   TimeDelta_t ffwrite(AddrType addr);
+  void        ffbatch(const MemWarmupOp *ops, size_t n);
 
   void tryPrefetch(AddrType addr, bool doStats, int degree, AddrType pref_sign, AddrType pc, CallbackBase *cb = 0);
 
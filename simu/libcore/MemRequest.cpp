@@ -38,6 +38,7 @@
 #include "SescConf.h"
 
 #include "GMemorySystem.h"
+#include "HostProfiler.h"
 
 #include "Cluster.h"
 #include "MemObj.h"
@@ -75,45 +76,55 @@ MemRequest::~MemRequest()
 //
 
 void MemRequest::redoReq() {
+  HostProfScope prof(HostProfiler::Mem);
   upce();
   currMemObj->doReq(this);
 }
 void MemRequest::redoReqAck() {
+  HostProfScope prof(HostProfiler::Mem);
   upce();
   currMemObj->doReqAck(this);
 }
 void MemRequest::redoSetState() {
+  HostProfScope prof(HostProfiler::Mem);
   upce();
   currMemObj->doSetState(this);
 }
 void MemRequest::redoSetStateAck() {
+  HostProfScope prof(HostProfiler::Mem);
   upce();
   currMemObj->doSetStateAck(this);
 }
 void MemRequest::redoDisp() {
+  HostProfScope prof(HostProfiler::Mem);
   upce();
   currMemObj->doDisp(this);
 }
 
 void MemRequest::startReq() {
+  HostProfScope prof(HostProfiler::Mem);
   I(mt == mt_req);
   currMemObj->req(this);
 }
 void MemRequest::startReqAck() {
+  HostProfScope prof(HostProfiler::Mem);
   I(mt == mt_reqAck || prefetch);
   currMemObj->reqAck(this);
 }
 void MemRequest::startSetState() {
+  HostProfScope prof(HostProfiler::Mem);
   I(mt == mt_setState);
   I(!prefetch);
   currMemObj->setState(this);
 }
 void MemRequest::startSetStateAck() {
+  HostProfScope prof(HostProfiler::Mem);
   I(mt == mt_setStateAck);
   I(!prefetch);
   currMemObj->setStateAck(this);
 }
 void MemRequest::startDisp() {
+  HostProfScope prof(HostProfiler::Mem);
   I(mt == mt_disp);
   currMemObj->disp(this);
 }
@@ -363,3 +374,30 @@ void MemRequest::destroy()
   actPool.in(this);
 }
 /*  */
+
+void MemRequestBatch::setSlots(uint32_t nSlots)
+/* enable the batch with nSlots pending cycles (0 disables it) */
+{
+  I(slots == 0);
+
+  if(nSlots == 0)
+    return;
+
+  nSlots   = roundUpPower2(nSlots);
+  slotMask = nSlots - 1;
+  slots    = new Slot[nSlots];
+  for(uint32_t i = 0; i < nSlots; i++)
+    slots[i].when = 0;
+}
+/*  */
+
+void MemRequestBatch::Slot::call()
+/* run the requests of this cycle in schedule order */
+{
+  // Requests scheduled from here for this cycle run inline, the ones for
+  // another cycle can not use this slot until it is empty
+  for(size_t i = 0; i < queue.size(); i++)
+    (queue[i].mreq->*queue[i].action)();
+  queue.clear();
+}
+/*  */
@@ -145,6 +145,7 @@ protected:
   void memDisp(); // E.g: L1 -> L2
 
   friend class MRouter; // only mrouter can call the req directly
+  friend class MemRequestBatch;
   void redoReq(TimeDelta_t lat) {
     redoReqCB.schedule(lat);
   }
@@ -689,6 +690,108 @@ public:
   }
 };
 
+// Per component batch of the MemRequest events. All the requests that a
+// component schedules for the same cycle go in one FIFO drained by a single
+// event, so the event queue sees one entry per component and cycle. Pending
+// cycles map to nSlots slots, a slot busy with another cycle (or a disabled
+// batch, nSlots == 0) uses the request's own callback.
+class MemRequestBatch {
+private:
+  typedef void (MemRequest::*Action)();
+
+  class Entry {
+  public:
+    MemRequest *mreq;
+    Action      action;
+  };
+
+  class Slot : public EventScheduler {
+  public:
+    Time_t             when;
+    std::vector<Entry> queue;
+
+    void call();
+  };
+
+  Slot *   slots;
+  uint32_t slotMask;
+
+  template <void (MemRequest::*action)(), StaticCallbackMember0<MemRequest, action> MemRequest::*cb>
+  void scheduleAbs(MemRequest *mreq, Time_t when) {
+    if(when == globalClock) {
+      (mreq->*action)();
+      return;
+    }
+
+    Slot *s = slots ? &slots[when & slotMask] : 0;
+    if(s == 0 || (!s->queue.empty() && s->when != when)) {
+      (mreq->*cb).scheduleAbs(when);
+      return;
+    }
+
+    if(s->queue.empty()) {
+      s->when = when;
+      EventScheduler::scheduleAbs(when, s);
+    }
+    Entry e;
+    e.mreq   = mreq;
+    e.action = action;
+    s->queue.push_back(e);
+  }
+
+public:
+  MemRequestBatch()
+      : slots(0)
+      , slotMask(0) {
+  }
+  ~MemRequestBatch() {
+    delete[] slots;
+  }
+
+  void setSlots(uint32_t nSlots);
+
+  void redoReqAbs(MemRequest *mreq, Time_t when) {
+    scheduleAbs<&MemRequest::redoReq, &MemRequest::redoReqCB>(mreq, when);
+  }
+  void redoReqAckAbs(MemRequest *mreq, Time_t when) {
+    scheduleAbs<&MemRequest::redoReqAck, &MemRequest::redoReqAckCB>(mreq, when);
+  }
+  void redoSetStateAbs(MemRequest *mreq, Time_t when) {
+    scheduleAbs<&MemRequest::redoSetState, &MemRequest::redoSetStateCB>(mreq, when);
+  }
+  void redoSetStateAckAbs(MemRequest *mreq, Time_t when) {
+    scheduleAbs<&MemRequest::redoSetStateAck, &MemRequest::redoSetStateAckCB>(mreq, when);
+  }
+  void redoDispAbs(MemRequest *mreq, Time_t when) {
+    scheduleAbs<&MemRequest::redoDisp, &MemRequest::redoDispCB>(mreq, when);
+  }
+
+  void startReq(MemRequest *mreq, MemObj *m, TimeDelta_t lat) {
+    mreq->setNextHop(m);
+    scheduleAbs<&MemRequest::startReq, &MemRequest::startReqCB>(mreq, globalClock + lat);
+  }
+  void startReqAck(MemRequest *mreq, MemObj *m, TimeDelta_t lat) {
+    mreq->setNextHop(m);
+    scheduleAbs<&MemRequest::startReqAck, &MemRequest::startReqAckCB>(mreq, globalClock + lat);
+  }
+  void startReqAckAbs(MemRequest *mreq, MemObj *m, Time_t when) {
+    mreq->setNextHop(m);
+    scheduleAbs<&MemRequest::startReqAck, &MemRequest::startReqAckCB>(mreq, when);
+  }
+  void startSetState(MemRequest *mreq, MemObj *m, TimeDelta_t lat) {
+    mreq->setNextHop(m);
+    scheduleAbs<&MemRequest::startSetState, &MemRequest::startSetStateCB>(mreq, globalClock + lat);
+  }
+  void startSetStateAck(MemRequest *mreq, MemObj *m, TimeDelta_t lat) {
+    mreq->setNextHop(m);
+    scheduleAbs<&MemRequest::startSetStateAck, &MemRequest::startSetStateAckCB>(mreq, globalClock + lat);
+  }
+  void startDisp(MemRequest *mreq, MemObj *m, TimeDelta_t lat) {
+    mreq->setNextHop(m);
+    scheduleAbs<&MemRequest::startDisp, &MemRequest::startDispCB>(mreq, globalClock + lat);
+  }
+};
+
 class MemRequestHashFunc {
 public:
   size_t operator()(const MemRequest *mreq) const {
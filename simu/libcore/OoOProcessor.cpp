@@ -48,6 +48,7 @@
 #include "EmuSampler.h"
 #include "FetchEngine.h"
 #include "GMemorySystem.h"
+#include "HostProfiler.h"
 #include "TaskHandler.h"
 #include "FastQueue.h"
 #include "MemRequest.h"
@@ -157,6 +158,8 @@ OoOProcessor::~OoOProcessor()
 void OoOProcessor::fetch(FlowID fid)
 /* fetch {{{1 */
 {
+  HostProfScope prof(HostProfiler::Fetch);
+
   I(fid == cpu_id);
   I(active);
   I(eint);
@@ -1122,6 +1125,7 @@ DataType OoOProcessor::extract_load_immediate(AddrType pc) {
 void OoOProcessor::retire()
 /* Try to retire instructions {{{1 */
 {
+  HostProfScope prof(HostProfiler::Retire);
 
 #ifdef ENABLE_LDBP
   int64_t gclock = int64_t(clockTicks.getDouble());
@@ -56,10 +56,6 @@ void IBucket::markFetched() {
   pipeLine->readyItem(this);
 }
 
-bool PipeIBucketLess::operator()(const IBucket *x, const IBucket *y) const {
-  return x->getPipelineId() > y->getPipelineId();
-}
-
 Pipeline::Pipeline(size_t s, size_t fetch, int32_t maxReqs)
     : PipeLength(s)
     , bucketPoolMaxSize(s + 1 + maxReqs)
@@ -80,6 +76,10 @@ Pipeline::Pipeline(size_t s, size_t fetch, int32_t maxReqs)
   }
 
   I(bucketPool.size() == bucketPoolMaxSize);
+
+  received.resize(roundUpPower2(bucketPoolMaxSize), 0);
+  receivedMask = received.size() - 1;
+  nReceived    = 0;
 }
 
 Pipeline::~Pipeline() {
@@ -91,10 +91,8 @@ Pipeline::~Pipeline() {
     delete buffer.top();
     buffer.pop();
   }
-  while(!received.empty()) {
-    delete received.top();
-    received.pop();
-  }
+  for(size_t i = 0; i < received.size(); i++)
+    delete received[i];
 }
 
 void Pipeline::readyItem(IBucket *b) {
@@ -102,7 +100,10 @@ void Pipeline::readyItem(IBucket *b) {
 
   nIRequests++;
   if(b->getPipelineId() != minItemCntr) {
-    received.push(b);
+    I(b->getPipelineId() - minItemCntr <= receivedMask);
+    I(received[b->getPipelineId() & receivedMask] == 0);
+    received[b->getPipelineId() & receivedMask] = b;
+    nReceived++;
     return;
   }
 
@@ -120,14 +121,14 @@ void Pipeline::readyItem(IBucket *b) {
 }
 
 void Pipeline::clearItems() {
-  while(!received.empty()) {
-    IBucket *b = received.top();
-
-    if(b->getPipelineId() != minItemCntr) {
+  while(nReceived) {
+    IBucket *b = received[minItemCntr & receivedMask];
+    if(b == 0)
       break;
-    }
 
-    received.pop();
+    I(b->getPipelineId() == minItemCntr);
+    received[minItemCntr & receivedMask] = 0;
+    nReceived--;
 
     minItemCntr++;
 
@@ -241,13 +242,13 @@ bool Pipeline::hasOutstandingItems() const {
     MSG("Pipeline !buffer.empty()");
   }
 
-  if (!received.empty()){
-    MSG("Pipeline !received.empty()");
+  if (nReceived){
+    MSG("Pipeline nReceived(%d)",nReceived);
   }
 
   if (nIRequests < MaxIRequests){
     MSG("Pipeline nIRequests(%d) < MaxIRequests(%d)",nIRequests, MaxIRequests);
   }
 #endif
-  return !buffer.empty() || !received.empty() || nIRequests < MaxIRequests;
+  return !buffer.empty() || nReceived || nIRequests < MaxIRequests;
 }
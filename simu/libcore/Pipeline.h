@@ -61,11 +61,6 @@
 typedef uint32_t CPU_t;
 class IBucket;
 
-class PipeIBucketLess {
-public:
-  bool operator()(const IBucket *x, const IBucket *y) const;
-};
-
 class Pipeline {
 private:
   const size_t         PipeLength;
@@ -77,10 +72,11 @@ private:
   typedef std::vector<IBucket *> IBucketCont;
   IBucketCont                    bucketPool;
 
-  // typedef boost::heap::priority_queue<IBucket *,boost::heap::compare<PipeIBucketLess> > ReceivedType;
-  typedef std::priority_queue<IBucket *, std::vector<IBucket *>, PipeIBucketLess> ReceivedType;
-  // std::priority_queue<IBucket *, std::vector<IBucket*>, PipeIBucketLess> received;
-  ReceivedType received;
+  // Buckets received out-of-order, indexed by pipeline id. The ids in
+  // flight (minItemCntr to maxItemCntr) are bounded by the bucket pool size.
+  IBucketCont received;
+  Time_t      receivedMask;
+  int32_t     nReceived;
 
   Time_t maxItemCntr;
   Time_t minItemCntr;
@@ -114,7 +110,6 @@ protected:
   Time_t clock;
 
   friend class Pipeline;
-  friend class PipeIBucketLess;
 
   Pipeline *const pipeLine;
   ID(bool fetched;)
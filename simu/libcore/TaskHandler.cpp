@@ -37,6 +37,7 @@
 #include "EmuSampler.h"
 #include "EmulInterface.h"
 #include "GProcessor.h"
+#include "HostProfiler.h"
 #include "Report.h"
 #include "SescConf.h"
 #include <iostream>
@@ -370,8 +371,12 @@ extern "C" void helper_esesc_dump();
 void            TaskHandler::boot()
 /* main simulation loop {{{1 */
 {
+  HostProfScope prof(HostProfiler::Boot);
+
   while(!terminate_all) {
     if(unlikely(running_size == 0)) {
+      HostProfScope profIdle(HostProfiler::Idle);
+
       bool needIncreaseClock = false;
       for(AllMapsType::iterator it = allmaps.begin(); it != allmaps.end(); it++) {
         if(it->emul == 0)
@@ -382,8 +387,10 @@ void            TaskHandler::boot()
           break;
         }
       }
-      if(needIncreaseClock)
+      if(needIncreaseClock) {
+        HostProfScope profEvents(HostProfiler::Events);
         EventScheduler::advanceClock();
+      }
     } else {
       // 1st Make sure that they have enough instructions
       bool one_failed;
@@ -462,6 +469,7 @@ void            TaskHandler::boot()
         I(allmaps[i].simu->isROBEmpty());
       }
 #endif
+      HostProfScope profEvents(HostProfiler::Events);
       EventScheduler::advanceClock();
     }
   }
@@ -474,6 +482,14 @@ void TaskHandler::unboot()
 }
 /* }}} */
 
+void TaskHandler::lockForFork() {
+  pthread_mutex_lock(&mutex);
+}
+
+void TaskHandler::unlockAfterFork() {
+  pthread_mutex_unlock(&mutex);
+}
+
 void TaskHandler::plugBegin()
 /* allocate objects {{{1 */
 {
@@ -488,6 +504,18 @@ void TaskHandler::plugBegin()
 }
 /* }}} */
 
+void TaskHandler::enableForkSamples()
+/* forked samples (SamplerBase::forkSample) must not copy the mutex taken {{{1 */
+{
+  static bool registered = false;
+  if(registered)
+    return;
+  registered = true;
+
+  pthread_atfork(lockForFork, unlockAfterFork, unlockAfterFork);
+}
+/* }}} */
+
 void TaskHandler::plugEnd()
 /* setup running and allmaps before starting the main loop {{{1 */
 {
@@ -71,13 +71,21 @@ private:
 
   static void removeFromRunning(FlowID fid);
 
+  static void lockForFork();
+  static void unlockAfterFork();
+
 public:
+  static void enableForkSamples();
+
   static void freeze(FlowID fid, Time_t nCycles);
 
   static FlowID resumeThread(FlowID uid, FlowID last_fid);
   static FlowID resumeThread(FlowID uid);
   static void   pauseThread(FlowID fid);
   static void   terminate();
+  static void   stopBoot() {
+    terminate_all = true; // boot returns, without the terminate handshake (forked samples)
+  }
 
   static void report(const char *str);
 
@@ -57,6 +57,10 @@ Bus::Bus(MemorySystem *current, const char *section, const char *name)
   sprintf(cadena, "Cmd%s", name);
   cmdPort = PortGeneric::create(cadena, num, 1);
 
+  // batchReqs > 0: one event per cycle for the requests sent through the bus
+  if(SescConf->checkInt(section, "batchReqs"))
+    router->enableBatch(SescConf->getInt(section, "batchReqs"));
+
   I(current);
   MemObj *lower_level = current->declareMemoryObj(section, "lowerLevel");
   if(lower_level) {
@@ -146,3 +150,10 @@ TimeDelta_t Bus::ffwrite(AddrType addr)
   return delay;
 }
 /* }}} */
+
+void Bus::ffbatch(const MemWarmupOp *ops, size_t n)
+/* fast forward batch {{{1 */
+{
+  // Same as ffread/ffwrite, the bus does not forward warmup accesses
+}
+/* }}} */
@@ -83,6 +83,7 @@ public:
 
   TimeDelta_t ffread(AddrType addr);
   TimeDelta_t ffwrite(AddrType addr);
+  void        ffbatch(const MemWarmupOp *ops, size_t n);
 
   void tryPrefetch(AddrType addr, bool doStats, int degree, AddrType pref_sign, AddrType pc, CallbackBase *cb = 0);
 
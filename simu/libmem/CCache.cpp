@@ -48,6 +48,8 @@ CCache::CCache(MemorySystem *gms, const char *section, const char *name)
     , invAll("%s:invAll", name)
     , invOne("%s:invOne", name)
     , invNone("%s:invNone", name)
+    , invSome("%s:invSome", name)
+    , invFiltered("%s:invFiltered", name)
     , writeBack("%s:writeBack", name)
     , lineFill("%s:lineFill", name)
     , avgMissLat("%s_avgMissLat", name)
@@ -120,6 +122,12 @@ CCache::CCache(MemorySystem *gms, const char *section, const char *name)
   s_reqSetState[ma_MMU]          = new GStatsCntr("%s:MMUSetState", name);
   s_reqSetState[ma_VPCWU]        = new GStatsCntr("%s:VPCMUSetState", name);
 
+  static const char *psignName[PSIGN_MAX] = {"none", "ras", "nline", "stride", "tage", "indirect", "chase", "mega"};
+  for(int i = 0; i < PSIGN_MAX; i++) {
+    nPrefetchFiltered[i] = new GStatsCntr("%s:nPrefetchFiltered_%s", name, psignName[i]);
+    nPrefetchIssued[i]   = new GStatsCntr("%s:nPrefetchIssued_%s", name, psignName[i]);
+  }
+
   // TODO: add support for coreCoupledFreq as part of mreq
   // if(SescConf->checkBool(section,"coreCoupledFreq")) {
   // MSG("WARNING: coreCoupledFreq does not work yet");
@@ -183,6 +191,25 @@ CCache::CCache(MemorySystem *gms, const char *section, const char *name)
   } else {
     prefetchDegree = 4;
   }
+  {
+    int32_t filterSize = 0;
+    if(SescConf->checkInt(section, "prefetchFilter")) {
+      filterSize = SescConf->getInt(section, "prefetchFilter");
+      if(filterSize)
+        SescConf->isPower2(section, "prefetchFilter");
+    }
+    PrefFilterEntry empty = {(AddrType)-1, 0};
+    prefFilter.resize(filterSize, empty);
+    prefFilterMask = filterSize ? filterSize - 1 : 0;
+
+    // Cycles a forwarded prefetch stays in the filter (about a lower level miss)
+    if(SescConf->checkInt(section, "prefetchFilterExpiry")) {
+      prefFilterExpiry = SescConf->getInt(section, "prefetchFilterExpiry");
+      SescConf->isGT(section, "prefetchFilterExpiry", 0);
+    } else {
+      prefFilterExpiry = 64;
+    }
+  }
   if(SescConf->checkDouble(section, "megaRatio")) {
     megaRatio = SescConf->getDouble(section, "megaRatio");
   } else {
@@ -305,20 +332,29 @@ void CCache::displaceLine(AddrType naddr, MemRequest *mreq, Line *l) {
     if(directory) {
       if(l->getSharingCount() == 0) {
         invNone.inc(doStats);
+        invFiltered.add(router->getnUpNodes(), doStats);
 
         // DONE! Nice directory tracking detected no higher level sharing
         if(l->isPrefetch())
           return; // No notification to lower level if prefetch (avoid overheads)
       } else if(l->getSharingCount() == 1) {
         invOne.inc(doStats);
+        invFiltered.add(router->getnUpNodes() - 1, doStats);
 
         MemRequest *inv_req = MemRequest::createSetState(this, this, ma_setInvalid, naddr, doStats);
         trackAddress(inv_req);
         int32_t i = router->sendSetStateOthersPos(l->getFirstSharingPos(), inv_req, ma_setInvalid, inOrderUpMessage());
         if(i == 0)
           inv_req->ack();
+      } else if(!l->isBroadcastNeeded()) {
+        invSome.inc(doStats);
+
+        MemRequest *inv_req = MemRequest::createSetState(this, this, ma_setInvalid, naddr, doStats);
+        trackAddress(inv_req);
+        int32_t i = sendSetStateSharers(l, -1, inv_req, ma_setInvalid);
+        if(i == 0)
+          inv_req->ack();
       } else {
-        // FIXME: optimize directory for 2 or more
         invAll.inc(doStats);
 
         MemRequest *inv_req = MemRequest::createSetState(this, this, ma_setInvalid, naddr, doStats);
@@ -494,7 +530,7 @@ bool CCache::CState::shouldNotifyHigherLevels(MemRequest *mreq, int16_t portid)
   if(nSharers == 0)
     return false;
 
-  if(nSharers == 1 && share[0] == portid)
+  if(nSharers == 1 && getFirstSharingPos() == portid)
     return false; // Nobody but requester
 
 #if 0
@@ -577,7 +613,7 @@ void CCache::CState::adjustState(MemRequest *mreq, int16_t portid)
   } else if(mreq->isSetStateAck()) {
     if(mreq->getAction() == ma_setInvalid) {
       if(isBroadcastNeeded())
-        nSharers = CCACHE_MAXNSHARERS - 1; // Broadcast was sent, remove broadcast need
+        endBroadcast(); // Broadcast was sent, remove broadcast need
       removeSharing(portid);
     } else {
       I(mreq->getAction() == ma_setShared);
@@ -668,6 +704,21 @@ bool CCache::notifyLowerLevels(Line *l, MemRequest *mreq)
 }
 // }}}
 
+int32_t CCache::sendSetStateSharers(Line *l, int16_t skip, MemRequest *mreq, MsgAction ma)
+// setState only to the sharers in the directory, but skip {{{1
+{
+  I(directory && !l->isBroadcastNeeded());
+
+  int32_t n = router->sendSetStateMask(l->getSharingMask(), skip, mreq, ma, inOrderUpMessage());
+
+  int32_t nAll = router->getnUpNodes() - (skip >= 0 ? 1 : 0); // what a broadcast sends
+  if(nAll > n)
+    invFiltered.add(nAll - n, mreq->getStatsFlag());
+
+  return n;
+}
+// }}}
+
 bool CCache::notifyHigherLevels(Line *l, MemRequest *mreq)
 // {{{1
 {
@@ -705,16 +756,7 @@ bool CCache::notifyHigherLevels(Line *l, MemRequest *mreq)
       router->sendSetStateOthers(mreq, ma, inOrderUpMessage());
       // I(num); // Otherwise, the need coherent would be set
     } else {
-      for(int16_t i = 0; i < l->getSharingCount(); i++) {
-        int16_t pos = l->getSharingPos(i);
-        if(pos != portid) {
-#ifdef DEBUG
-          int32_t j =
-#endif
-              router->sendSetStateOthersPos(l->getSharingPos(i), mreq, ma, inOrderUpMessage());
-          I(j);
-        }
-      }
+      sendSetStateSharers(l, portid, mreq, ma);
     }
 
     // If mreq has pending stateack, it should not complete the read now
@@ -738,21 +780,18 @@ void CCache::CState::addSharing(int16_t id) { /*{{{*/
   }
 
   I(id >= 0); // portid<0 means no portid found
-  if(nSharers == 0) {
-    share[0] = id;
-    nSharers++;
-    GI(nSharers > 1, shareState == S);
+  if(id >= 64) {
+    nSharers = CCACHE_MAXNSHARERS; // Not in the bitmap, broadcast
     return;
   }
 
-  for(int i = 0; i < nSharers; i++) {
-    if(share[i] == id) {
-      return;
-    }
-  }
+  uint64_t bit = 1ULL << id;
+  if(sharers & bit)
+    return;
 
-  share[nSharers] = id;
+  sharers |= bit;
   nSharers++;
+  GI(nSharers > 1, shareState == S);
 } /*}}}*/
 
 void CCache::CState::removeSharing(int16_t id)
@@ -761,16 +800,30 @@ void CCache::CState::removeSharing(int16_t id)
   if(nSharers >= CCACHE_MAXNSHARERS)
     return; // not possible to remove if in broadcast mode
 
-  for(int16_t i = 0; i < nSharers; i++) {
-    if(share[i] == id) {
-      for(int16_t j = i; j < (nSharers - 1); j++) {
-        share[j] = share[j + 1];
-      }
-      nSharers--;
-      if(nSharers == 0)
-        shareState = I;
-      return;
-    }
+  if(id < 0 || id >= 64)
+    return;
+
+  uint64_t bit = 1ULL << id;
+  if((sharers & bit) == 0)
+    return;
+
+  sharers &= ~bit;
+  nSharers--;
+  if(nSharers == 0)
+    shareState = I;
+}
+// }}}
+
+void CCache::CState::endBroadcast()
+// back to the sharers still in the bitmap {{{1
+{
+  I(isBroadcastNeeded());
+
+  nSharers = __builtin_popcountll(sharers);
+  if(nSharers >= CCACHE_MAXNSHARERS) {
+    // Same as before, the last sharer tracked is forgotten
+    sharers &= ~(1ULL << 63);
+    nSharers = CCACHE_MAXNSHARERS - 1;
   }
 }
 // }}}
@@ -1217,11 +1270,15 @@ void CCache::doSetState(MemRequest *mreq)
     if(directory) {
       if(l->getSharingCount() == 1) {
         invOne.inc(mreq->getStatsFlag());
+        invFiltered.add(router->getnUpNodes() - 1, mreq->getStatsFlag());
         int32_t i = router->sendSetStateOthersPos(l->getFirstSharingPos(), mreq, mreq->getAction(), inOrderUpMessage());
         I(i);
+      } else if(l->getSharingCount() > 1 && !l->isBroadcastNeeded()) {
+        invSome.inc(mreq->getStatsFlag());
+        int32_t nmsg = sendSetStateSharers(l, -1, mreq, mreq->getAction());
+        I(nmsg);
       } else {
         invAll.inc(mreq->getStatsFlag());
-        // FIXME: optimize directory for 2 or more
         int32_t nmsg = router->sendSetStateAll(mreq, mreq->getAction(), inOrderUpMessage());
         I(nmsg);
       }
@@ -1367,10 +1424,18 @@ void CCache::tryPrefetch(AddrType paddr, bool doStats, int degree, AddrType pref
     return;
   }
 
+  if(prefFiltered(paddr)) {
+    nPrefetchFiltered[pref_sign < PSIGN_MAX ? pref_sign : PSIGN_NONE]->inc(doStats);
+    if(cb)
+      cb->destroy();
+    return;
+  }
+
   if(!allocateMiss) {
     AddrType page_addr = (paddr >> 10) << 10;
     if(pref_sign != PSIGN_MEGA || page_addr != paddr) {
       nPrefetchHitBusy.inc(doStats);
+      prefIssued(paddr, pref_sign, doStats, true);
       router->tryPrefetch(paddr, doStats, degree, pref_sign, pc, cb);
       return;
     }
@@ -1382,11 +1447,13 @@ void CCache::tryPrefetch(AddrType paddr, bool doStats, int degree, AddrType pref
 
   if(port->isBusy(paddr) || degree > prefetchDegree || victim) {
     nPrefetchHitBusy.inc(doStats);
+    prefIssued(paddr, pref_sign, doStats, true);
     router->tryPrefetch(paddr, doStats, degree, pref_sign, pc, cb);
     return;
   }
 
   nSendPrefetch.inc(doStats);
+  prefIssued(paddr, pref_sign, doStats, false);
   if(cb) {
     // I(pref_sign==PSIGN_STRIDE);
     // static_cast<IndirectAddressPredictor::performedCB *>(cb)->setParam1(this);
@@ -1400,6 +1467,22 @@ void CCache::tryPrefetch(AddrType paddr, bool doStats, int degree, AddrType pref
 }
 // }}}
 
+void CCache::prefIssued(AddrType paddr, AddrType pref_sign, bool doStats, bool forwarded)
+/* count a prefetch that leaves this cache, remember it if forwarded {{{1 */
+{
+  nPrefetchIssued[pref_sign < PSIGN_MAX ? pref_sign : PSIGN_NONE]->inc(doStats);
+
+  // A prefetch sent from here blocks the MSHR and then fills the line, the
+  // probes in tryPrefetch already catch a repeated one
+  if(!forwarded || prefFilter.empty())
+    return;
+
+  PrefFilterEntry &e = prefFilter[calcPrefFilterPos(paddr)];
+  e.line             = paddr >> lineSizeBits;
+  e.expire           = globalClock + prefFilterExpiry;
+}
+// }}}
+
 bool CCache::isBusy(AddrType addr) const
 /* check if CCache can accept more writes {{{1 */
 {
@@ -1452,6 +1535,56 @@ TimeDelta_t CCache::ffwrite(AddrType addr)
 }
 // }}}
 
+void CCache::ffbatch(const MemWarmupOp *ops, size_t n)
+/* batched ffread/ffwrite {{{1 */
+{
+  if(n == 0)
+    return;
+
+  ffAddr.resize(n);
+  for(size_t i = 0; i < n; i++)
+    ffAddr[i] = ops[i].addr;
+
+  cacheBank->groupBySet(&ffAddr[0], n, ffOrder);
+
+  ffForward.assign(n, 0);
+  for(size_t j = 0; j < n; j++) {
+    uint32_t           i      = ffOrder[j];
+    const MemWarmupOp &op     = ops[i];
+    AddrType           pc     = op.pc ? op.pc : 0xbeefbeef;
+    AddrType           addr_r = 0;
+
+    if(op.write) {
+      Line *l = cacheBank->writeLine(op.addr, op.pc);
+      if(l == 0)
+        l = cacheBank->fillLine_replace(op.addr, addr_r, pc);
+      if(router->isTopLevel())
+        l->setModified(); // WARNING, can create random inconsistencies (no inv others)
+      else
+        l->setExclusive();
+      ffForward[i] = 1; // Same as ffwrite, writes always go down
+    } else {
+      Line *l = cacheBank->readLine(op.addr, op.pc);
+      if(l)
+        continue;
+      l = cacheBank->fillLine_replace(op.addr, addr_r, pc);
+      l->setExclusive(); // WARNING, can create random inconsistencies (no inv others)
+      ffForward[i] = 1;
+    }
+  }
+
+  // The lower level sees the misses in the original order
+  ffLower.clear();
+  for(size_t i = 0; i < n; i++) {
+    if(ffForward[i])
+      ffLower.push_back(ops[i]);
+  }
+
+  if(!ffLower.empty())
+    router->ffbatch(&ffLower[0], ffLower.size());
+}
+// }}}
+
 void CCache::setTurboRatio(float r)
 // {{{1
 {
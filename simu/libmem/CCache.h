@@ -64,16 +64,22 @@ class CCache : public MemObj {
 protected:
   class CState : public StateGeneric<AddrType> { /*{{{*/
   private:
-    enum StateType { M, E, S, I };
+    enum StateType : uint8_t { M, E, S, I };
+
+    // Directory: up node positions sharing the line. Positions over 63, or
+    // CCACHE_MAXNSHARERS sharers, switch to broadcast (nSharers==MAX).
+    // Ordered so that the small fields (and the CacheLine ones) pack at the end
+    uint64_t  sharers;
+    int16_t   nSharers;
     StateType state;
     StateType shareState;
 
-    int16_t nSharers;
-    int16_t share[CCACHE_MAXNSHARERS]; // Max number of shares to remember. If nshares >=8, then broadcast
-
   public:
     CState(int32_t lineSize) {
-      state = I;
+      state      = I;
+      shareState = I;
+      nSharers   = 0;
+      sharers    = 0;
       clearTag();
     }
 
@@ -153,6 +159,7 @@ protected:
     void invalidate() {
       state      = I;
       nSharers   = 0;
+      sharers    = 0;
       shareState = I;
       clearTag();
     }
@@ -166,15 +173,18 @@ protected:
     }
     void    removeSharing(int16_t id);
     void    addSharing(int16_t id);
+    void    endBroadcast();
     int16_t getFirstSharingPos() const {
-      return share[0];
+      I(sharers);
+      return __builtin_ctzll(sharers);
     }
-    int16_t getSharingPos(int16_t pos) const {
-      I(pos < nSharers);
-      return share[pos];
+    uint64_t getSharingMask() const {
+      I(!isBroadcastNeeded());
+      return sharers;
     }
     void clearSharing() {
       nSharers = 0;
+      sharers  = 0;
     }
 
     void set(const MemRequest *mreq);
@@ -220,6 +230,18 @@ protected:
   int32_t nlprefetchStride;
   int32_t prefetchDegree;
 
+  // Recent prefetch filter: line address of the last prefetches forwarded
+  // down by this cache (busy, too deep, !allocateMiss), direct mapped
+  // (empty == off). They leave no MSHR entry nor line here, so a repeated
+  // prefetch would create a new request until the entry expires.
+  struct PrefFilterEntry {
+    AddrType line;
+    Time_t   expire;
+  };
+  std::vector<PrefFilterEntry> prefFilter;
+  AddrType                     prefFilterMask;
+  TimeDelta_t                  prefFilterExpiry;
+
   int32_t moving_conf;
   double  megaRatio;
 
@@ -242,6 +264,8 @@ protected:
   GStatsCntr invAll;
   GStatsCntr invOne;
   GStatsCntr invNone;
+  GStatsCntr invSome;     // 2 or more sharers, sent only to them (directory)
+  GStatsCntr invFiltered; // setState messages avoided by the directory
 
   GStatsCntr writeBack;
 
@@ -266,6 +290,8 @@ protected:
   GStatsCntr nPrefetchHitPending;
   GStatsCntr nPrefetchHitBusy;
   GStatsCntr nPrefetchDropped;
+  GStatsCntr *nPrefetchFiltered[PSIGN_MAX]; // per pref_sign, discarded by prefFilter
+  GStatsCntr *nPrefetchIssued[PSIGN_MAX];   // per pref_sign, sent or forwarded down
 
   GStatsCntr *s_reqHit[ma_MAX];
   GStatsCntr *s_reqMissLine[ma_MAX];
@@ -282,6 +308,25 @@ protected:
   AddrType maxMissAddr;
 
   // END Statistics
+
+  // ffbatch scratch space (kept to avoid allocations per batch)
+  std::vector<AddrType> ffAddr;
+  std::vector<uint32_t> ffOrder;
+  std::vector<uint8_t>  ffForward;
+  MemWarmupBatch        ffLower;
+
+  uint32_t calcPrefFilterPos(AddrType paddr) const {
+    AddrType line = paddr >> lineSizeBits;
+    return (line ^ (line >> 7)) & prefFilterMask;
+  }
+  bool prefFiltered(AddrType paddr) const {
+    if(prefFilter.empty())
+      return false;
+    const PrefFilterEntry &e = prefFilter[calcPrefFilterPos(paddr)];
+    return e.line == (paddr >> lineSizeBits) && globalClock < e.expire;
+  }
+  void prefIssued(AddrType paddr, AddrType pref_sign, bool doStats, bool forwarded);
+
   void  displaceLine(AddrType addr, MemRequest *mreq, Line *l);
   Line *allocateLine(AddrType addr, MemRequest *mreq);
   void  mustForwardReqDown(MemRequest *mreq, bool miss, Line *l);
@@ -291,6 +336,8 @@ protected:
 
   void dropPrefetch(MemRequest *mreq);
 
+  int32_t sendSetStateSharers(Line *l, int16_t skip, MemRequest *mreq, MsgAction ma);
+
   void
                                                   cleanup(); // FIXME: Expose this to MemObj and call it from core on ctx switch or syscall (move to public and remove callback)
   StaticCallbackMember0<CCache, &CCache::cleanup> cleanupCB;
@@ -323,6 +370,7 @@ public:
 
   TimeDelta_t ffread(AddrType addr);
   TimeDelta_t ffwrite(AddrType addr);
+  void        ffbatch(const MemWarmupOp *ops, size_t n);
 
   bool isBusy(AddrType addr) const;
 
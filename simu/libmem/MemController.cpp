@@ -93,12 +93,27 @@ MemController::MemController(MemorySystem *current, const char *section, const c
   bankMask   = numBanks - 1;
   bankMask   = bankMask << bankOffset;
 
-  bankState = new BankStatus[numBanks];
-  for(uint32_t curBank = 0; curBank < numBanks; curBank++) {
-    bankState[curBank].activeRow = 0;
-    bankState[curBank].state     = INIT; // Changed from ACTIVE (LNB)
-    bankState[curBank].bankTime  = 0;    // added (LNB)
+  numChannels = 1;
+  if(SescConf->checkInt(section, "numChannels")) {
+    numChannels = SescConf->getInt(section, "numChannels");
+    SescConf->isBetween(section, "numChannels", 1, 64);
+    SescConf->isPower2(section, "numChannels");
+  }
+  log2Channels = log2i(numChannels);
+  channelMask  = numChannels - 1;
+
+  channelShift = columnOffset; // Interleave channels every ColumnSize bytes
+  if(SescConf->checkInt(section, "channelShift")) {
+    channelShift = SescConf->getInt(section, "channelShift");
+    SescConf->isBetween(section, "channelShift", 0, 40);
   }
+  channelXor = false;
+  if(SescConf->checkBool(section, "channelXor"))
+    channelXor = SescConf->getBool(section, "channelXor");
+
+  for(uint32_t i = 0; i < numChannels; i++)
+    channels.push_back(new Channel(this, i));
+
   I(current);
   lower_level = current->declareMemoryObj(section, "lowerLevel");
   if(lower_level)
@@ -173,34 +188,68 @@ TimeDelta_t MemController::ffwrite(AddrType addr)
 }
 /* }}} */
 
+void MemController::ffbatch(const MemWarmupOp *ops, size_t n)
+/* fast forward batch {{{1 */
+{
+  // No state to warm
+}
+/* }}} */
+
+MemController::Channel::Channel(MemController *_mc, uint32_t id)
+    : mc(_mc)
+    , manageRamCB(this, std::max(std::max(mc->PreChargeLatency, mc->RowAccessLatency), mc->ColumnAccessLatency) + 1) {
+  bankState = new BankStatus[mc->numBanks];
+  for(uint32_t curBank = 0; curBank < mc->numBanks; curBank++) {
+    bankState[curBank].activeRow = 0;
+    bankState[curBank].state     = INIT; // Changed from ACTIVE (LNB)
+    bankState[curBank].bankTime  = 0;    // added (LNB)
+    bankState[curBank].bpend     = false;
+    bankState[curBank].cpend     = false;
+  }
+
+  nReq = 0;
+  if(mc->numChannels > 1)
+    nReq = new GStatsCntr("%s:ch(%d)_nReq", mc->getName(), id);
+}
+
 void MemController::addMemRequest(MemRequest *mreq) {
   FCFSField *newEntry = new FCFSField;
 
-  newEntry->Bank        = getBank(mreq);
-  newEntry->Row         = getRow(mreq);
-  newEntry->Column      = getColumn(mreq);
+  AddrType addr = getChannelAddr(mreq->getAddr());
+
+  newEntry->Bank        = getBank(addr);
+  newEntry->Row         = getRow(addr);
+  newEntry->Column      = getColumn(addr);
   newEntry->mreq        = mreq;
   newEntry->TimeEntered = globalClock;
 
-  OverflowMemoryRequests.push(newEntry);
+  channels[getChannel(mreq->getAddr())]->addMemRequest(newEntry);
+}
+
+void MemController::Channel::addMemRequest(FCFSField *entry) {
+  if(nReq)
+    nReq->inc(entry->mreq->getStatsFlag());
+
+  OverflowMemoryRequests.push(entry);
 
   manageRam();
 }
 
 // This function implements the FR-FCFS memory scheduling algorithm
-void MemController::manageRam(void) {
+void MemController::Channel::manageRam(void) {
+  const uint32_t numBanks = mc->numBanks;
 
   // First, we need to determine if any actions (precharging, activating, or accessing) have been completed
   for(uint32_t curBank = 0; curBank < numBanks; curBank++) {
-    if((bankState[curBank].state == PRECHARGE) && (globalClock - bankState[curBank].bankTime >= PreChargeLatency)) {
+    if((bankState[curBank].state == PRECHARGE) && (globalClock - bankState[curBank].bankTime >= mc->PreChargeLatency)) {
 
       bankState[curBank].state = IDLE;
 
-    } else if((bankState[curBank].state == ACTIVATING) && (globalClock - bankState[curBank].bankTime >= RowAccessLatency)) {
+    } else if((bankState[curBank].state == ACTIVATING) && (globalClock - bankState[curBank].bankTime >= mc->RowAccessLatency)) {
 
       bankState[curBank].state = ACTIVE;
 
-    } else if((bankState[curBank].state == ACCESSING) && (globalClock - bankState[curBank].bankTime >= ColumnAccessLatency)) {
+    } else if((bankState[curBank].state == ACCESSING) && (globalClock - bankState[curBank].bankTime >= mc->ColumnAccessLatency)) {
 
       bankState[curBank].state = ACTIVE;
 
@@ -226,12 +275,13 @@ void MemController::manageRam(void) {
 
             Time_t delta = globalClock - tempMem->TimeEntered;
 
-            router->scheduleReqAck(mreq, 1); //  Fixed doReq acknowledge -- LNB 5/28/2014
-            avgMemLat.sample(delta, mreq->getStatsFlag());
+            mc->router->scheduleReqAck(mreq, 1); //  Fixed doReq acknowledge -- LNB 5/28/2014
+            mc->avgMemLat.sample(delta, mreq->getStatsFlag());
           }
           IS(tempMem->mreq = 0);
 
           curMemRequests.erase(it);
+          delete tempMem;
 
           break;
         }
@@ -246,15 +296,17 @@ void MemController::manageRam(void) {
 }
 
 // This function adds any pending references in the queue to the buffer if there is space available
-void MemController::transferOverflowMemory(void) {
-  while((curMemRequests.size() <= memRequestBufferSize) && (!OverflowMemoryRequests.empty())) {
+void MemController::Channel::transferOverflowMemory(void) {
+  while((curMemRequests.size() <= mc->memRequestBufferSize) && (!OverflowMemoryRequests.empty())) {
     curMemRequests.push_back(OverflowMemoryRequests.front());
     OverflowMemoryRequests.pop();
   }
 }
 
 // This function determines what action can be performed next and schedules a callback for when that action completes
-void MemController::scheduleNextAction(void) {
+void MemController::Channel::scheduleNextAction(void) {
+  const uint32_t numBanks = mc->numBanks;
+
   uint32_t curBank, curRow;
   uint32_t oldestReadyColsBank = numBanks + 1;
   uint32_t oldestReadyRowsBank = numBanks + 1;
@@ -313,37 +365,37 @@ void MemController::scheduleNextAction(void) {
     bankState[oldestbank].state    = PRECHARGE;
     bankState[oldestbank].bankTime = globalClock;
 
-    nPrecharge.inc();
+    mc->nPrecharge.inc();
 
-    ManageRamCB::schedule(PreChargeLatency, this);
+    manageRamCB.schedule(mc->PreChargeLatency);
   } else if(oldestColumnFound) {
     bankState[oldestReadyColsBank].state    = ACCESSING;
     bankState[oldestReadyColsBank].bankTime = globalClock;
 
-    nColumnAccess.inc();
+    mc->nColumnAccess.inc();
 
-    ManageRamCB::schedule(ColumnAccessLatency, this);
+    manageRamCB.schedule(mc->ColumnAccessLatency);
   } else if(oldestRowFound) {
     bankState[oldestReadyRowsBank].state     = ACTIVATING;
     bankState[oldestReadyRowsBank].bankTime  = globalClock;
     bankState[oldestReadyRowsBank].activeRow = oldestReadyRow;
 
-    nRowAccess.inc();
+    mc->nRowAccess.inc();
 
-    ManageRamCB::schedule(RowAccessLatency, this);
+    manageRamCB.schedule(mc->RowAccessLatency);
   }
 }
 
-uint32_t MemController::getBank(MemRequest *mreq) const {
-  uint32_t bank = (mreq->getAddr() & bankMask) >> bankOffset;
+uint32_t MemController::getBank(AddrType addr) const {
+  uint32_t bank = (addr & bankMask) >> bankOffset;
   return bank;
 }
-uint32_t MemController::getRow(MemRequest *mreq) const {
-  uint32_t row = (mreq->getAddr() & rowMask) >> rowOffset;
+uint32_t MemController::getRow(AddrType addr) const {
+  uint32_t row = (addr & rowMask) >> rowOffset;
   return row;
 }
 
-uint32_t MemController::getColumn(MemRequest *mreq) const {
-  uint32_t column = (mreq->getAddr() & columnMask) >> columnOffset;
+uint32_t MemController::getColumn(AddrType addr) const {
+  uint32_t column = (addr & columnMask) >> columnOffset;
   return column;
 }
@@ -93,6 +93,16 @@ protected:
   uint32_t numBanks;
   uint32_t memRequestBufferSize;
 
+  // Channels: the channel bits (channelShift, log2(numChannels) wide) are
+  // removed from the address before the bank/row/column decode, so each
+  // channel sees a dense address space. With channelXor the row bits are
+  // folded into the channel index to spread row conflicts.
+  uint32_t numChannels;
+  uint32_t channelMask;
+  uint32_t channelShift;
+  uint32_t log2Channels;
+  bool     channelXor;
+
   class BankStatus {
   public:
     int      state;
@@ -102,12 +112,44 @@ protected:
     Time_t   bankTime;
   };
 
-  BankStatus *bankState;
-
   typedef std::vector<FCFSField *> FCFSList;
-  FCFSList                         curMemRequests;
   typedef std::queue<FCFSField *>  FCFSQueue;
-  FCFSQueue                        OverflowMemoryRequests;
+
+  // Per channel request buffers and bank state. Channels only share the
+  // timing parameters and the statistics, each one runs its own FR-FCFS
+  // scheduler with its own callback.
+  class Channel {
+  public:
+    MemController *mc;
+    BankStatus *   bankState;
+    FCFSList       curMemRequests;
+    FCFSQueue      OverflowMemoryRequests;
+    GStatsCntr *   nReq;
+
+    Channel(MemController *_mc, uint32_t id);
+
+    void addMemRequest(FCFSField *entry);
+    void manageRam(void);
+    void transferOverflowMemory(void);
+    void scheduleNextAction(void);
+
+    // One event per channel and cycle, no matter how many actions end then
+    CoalescedCallbackMember0<Channel, &Channel::manageRam> manageRamCB;
+  };
+
+  std::vector<Channel *> channels;
+
+  uint32_t getChannel(AddrType addr) const {
+    uint32_t ch = (addr >> channelShift) & channelMask;
+    if(channelXor)
+      ch ^= (getChannelAddr(addr) >> rowOffset) & channelMask;
+    return ch;
+  }
+  AddrType getChannelAddr(AddrType addr) const {
+    // Address with the channel bits removed
+    AddrType low = addr & ((((AddrType)1) << channelShift) - 1);
+    return ((addr >> (channelShift + log2Channels)) << channelShift) | low;
+  }
 
 public:
   MemController(MemorySystem *current, const char *device_descr_section, const char *device_name = NULL);
@@ -142,27 +184,21 @@ public:
 
   TimeDelta_t ffread(AddrType addr);
   TimeDelta_t ffwrite(AddrType addr);
+  void        ffbatch(const MemWarmupOp *ops, size_t n);
 
   bool isBusy(AddrType addr) const;
 
   uint16_t getLineSize() const;
 
-  void manageRam(void);
-
-  typedef CallbackMember0<MemController, &MemController::manageRam> ManageRamCB;
-  // typedef CallbackMember0<MemController, &MemController::manageRam>   ManageRamCB;  // Added by LNB 5/27/2014
 
   // TimeDelta_t ffread(AddrType addr, DataType data);
   // TimeDelta_t ffwrite(AddrType addr, DataType data);
   // void        ffinvalidate(AddrType addr, int32_t lineSize);
 private:
-  uint32_t getBank(MemRequest *mreq) const;
-  uint32_t getRow(MemRequest *mreq) const;
-  uint32_t getColumn(MemRequest *mreq) const;
+  uint32_t getBank(AddrType addr) const;
+  uint32_t getRow(AddrType addr) const;
+  uint32_t getColumn(AddrType addr) const;
   void     addMemRequest(MemRequest *mreq);
-
-  void transferOverflowMemory(void);
-  void scheduleNextAction(void);
 };
 
 #endif
@@ -186,3 +186,19 @@ TimeDelta_t MemXBar::ffwrite(AddrType addr)
   return router->ffwritePos(pos, addr);
 }
 /* }}} */
+
+void MemXBar::ffbatch(const MemWarmupOp *ops, size_t n)
+/* fast forward batch, split per bank {{{1 */
+{
+  ffBank.resize(numLowerLevelBanks);
+  for(size_t i = 0; i < n; i++)
+    ffBank[addrHash(ops[i].addr)].push_back(ops[i]);
+
+  for(uint32_t pos = 0; pos < numLowerLevelBanks; pos++) {
+    if(ffBank[pos].empty())
+      continue;
+    router->ffbatchPos(pos, &ffBank[pos][0], ffBank[pos].size());
+    ffBank[pos].clear();
+  }
+}
+/* }}} */
@@ -49,6 +49,8 @@ protected:
 
   GStatsCntr **XBar_rw_req;
 
+  std::vector<MemWarmupBatch> ffBank; // ffbatch split per lower level bank
+
 public:
   MemXBar(MemorySystem *current, const char *device_descr_section, const char *device_name = NULL);
   MemXBar(const char *section, const char *name);
@@ -86,6 +88,7 @@ public:
 
   TimeDelta_t ffread(AddrType addr);
   TimeDelta_t ffwrite(AddrType addr);
+  void        ffbatch(const MemWarmupOp *ops, size_t n);
 
   bool isBusy(AddrType addr) const;
 
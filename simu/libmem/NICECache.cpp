@@ -63,6 +63,8 @@ NICECache::NICECache(MemorySystem *gms, const char *section, const char *sName)
   warmupStep      = warmupStepStart;
   warmupNext      = 16;
   warmupSlowEvery = 16;
+
+  warmup.resize(1 << (32 - WarmupChunkBits), 0);
 }
 /* }}} */
 
@@ -77,7 +79,7 @@ void NICECache::doReq(MemRequest *mreq)
   readHit.inc(mreq->getStatsFlag());
 
   if(mreq->isHomeNode()) {
-    if(coldWarmup && warmup.find(mreq->getAddr() >> bsizeLog2) == warmup.end()) {
+    if(coldWarmup && firstTouch(mreq->getAddr())) {
 
       TimeDelta_t lat;
       warmupNext--;
@@ -94,7 +96,6 @@ void NICECache::doReq(MemRequest *mreq)
       } else {
         hdelay = 1;
       }
-      warmup.insert(mreq->getAddr() >> bsizeLog2);
     }
     mreq->ack(hdelay);
     return;
@@ -107,8 +108,7 @@ void NICECache::doReq(MemRequest *mreq)
     // MSG("wrnice %x",mreq->getAddr());
   }
 
-  if(coldWarmup && warmup.find(mreq->getAddr() >> bsizeLog2) == warmup.end()) {
-    warmup.insert(mreq->getAddr() >> bsizeLog2);
+  if(coldWarmup && firstTouch(mreq->getAddr())) {
     TimeDelta_t lat;
     warmupNext--;
     if(warmupNext <= 0) {
@@ -188,3 +188,10 @@ TimeDelta_t NICECache::ffwrite(AddrType addr)
   return 1;
 }
 /* }}} */
+
+void NICECache::ffbatch(const MemWarmupOp *ops, size_t n)
+/* warmup fast forward batch {{{1 */
+{
+  // Always hits, nothing to warm
+}
+/* }}} */
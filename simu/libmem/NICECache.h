@@ -51,11 +51,28 @@ private:
 
   bool coldWarmup;
 
-  HASH_SET<uint32_t> warmup;
-  uint32_t           warmupStepStart;
-  uint32_t           warmupStep;
-  uint32_t           warmupNext;
-  uint32_t           warmupSlowEvery;
+  // Lines touched by coldWarmup, a bitmap allocated in chunks of
+  // 2^WarmupChunkBits lines on first touch
+  enum { WarmupChunkBits = 18 };
+  std::vector<uint64_t *> warmup;
+  uint32_t                warmupStepStart;
+  uint32_t                warmupStep;
+  uint32_t                warmupNext;
+  uint32_t                warmupSlowEvery;
+
+  bool firstTouch(AddrType addr) {
+    uint32_t line  = addr >> bsizeLog2;
+    uint32_t chunk = line >> WarmupChunkBits;
+    if(warmup[chunk] == 0)
+      warmup[chunk] = (uint64_t *)calloc(1 << (WarmupChunkBits - 6), sizeof(uint64_t));
+
+    uint64_t *w   = &warmup[chunk][(line >> 6) & ((1 << (WarmupChunkBits - 6)) - 1)];
+    uint64_t  bit = 1ULL << (line & 63);
+    if(*w & bit)
+      return false;
+    *w |= bit;
+    return true;
+  }
 
 protected:
   // BEGIN Statistics
@@ -106,6 +123,7 @@ public:
 
   TimeDelta_t ffread(AddrType addr);
   TimeDelta_t ffwrite(AddrType addr);
+  void        ffbatch(const MemWarmupOp *ops, size_t n);
 
   bool isBusy(AddrType addr) const;
 };
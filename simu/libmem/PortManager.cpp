@@ -18,9 +18,14 @@ PortManager *PortManager::create(const char *section, MemObj *mobj) {
 }
 
 PortManagerBanked::PortManagerBanked(const char *section, MemObj *_mobj)
-    : PortManager(_mobj) {
-  int numPorts = SescConf->getInt(section, "bkNumPorts");
-  int portOccp = SescConf->getInt(section, "bkPortOccp");
+    : PortManager(_mobj)
+    , overflow(64) {
+  bkNumPorts = SescConf->getInt(section, "bkNumPorts");
+  bkPortOccp = SescConf->getInt(section, "bkPortOccp");
+  if(bkNumPorts == 0) // Same as PortGeneric::create, unlimited ports
+    bkPortOccp = 0;
+  if(bkPortOccp == 0)
+    bkNumPorts = 1;
 
   char        tmpName[512];
   const char *name = mobj->getName();
@@ -53,13 +58,13 @@ PortManagerBanked::PortManagerBanked(const char *section, MemObj *_mobj)
   else
     numBanksMask = 0;
 
-  bkPort = new PortGeneric *[numBanks];
-  for(uint32_t i = 0; i < numBanks; i++) {
-    sprintf(tmpName, "%s_bk(%d)", name, i);
-    bkPort[i] = PortGeneric::create(tmpName, numPorts, portOccp);
-    I(bkPort[i]);
-  }
-  I(bkPort[0]);
+  bkPortBusy = new Time_t[numBanks * bkNumPorts];
+  for(uint32_t i = 0; i < numBanks * bkNumPorts; i++)
+    bkPortBusy[i] = globalClock;
+
+  bkAvgTime = new GStatsAvg *[numBanks];
+  for(uint32_t i = 0; i < numBanks; i++)
+    bkAvgTime[i] = new GStatsAvg("%s_bk(%d)_occ", name, i);
   int fillPorts = 1;
   int fillOccp  = 1;
   if(SescConf->checkInt(section, "sendFillPortOccp")) {
@@ -105,25 +110,21 @@ PortManagerBanked::PortManagerBanked(const char *section, MemObj *_mobj)
     recvFillWidth = lineSize;
   }
 
-  blockTime = 0;
-}
-
-Time_t PortManagerBanked::nextBankSlot(AddrType addr, bool en) {
-  int32_t bank = (addr >> bankShift) & numBanksMask;
+  // batchReqs > 0: one event per cycle for the requests this cache schedules
+  if(SescConf->checkInt(section, "batchReqs"))
+    batch.setSlots(SescConf->getInt(section, "batchReqs"));
 
-  return bkPort[bank]->nextSlot(en);
-}
-
-Time_t PortManagerBanked::calcNextBankSlot(AddrType addr) {
-  int32_t bank = (addr >> bankShift) & numBanksMask;
-
-  return bkPort[bank]->calcNextSlot();
+  blockTime = 0;
 }
 
 void PortManagerBanked::nextBankSlotUntil(AddrType addr, Time_t until, bool en) {
-  uint32_t bank = (addr >> bankShift) & numBanksMask;
+  // Same as PortGeneric::occupyUntil
+  if(bkPortOccp == 0)
+    return;
 
-  bkPort[bank]->occupyUntil(until);
+  Time_t t = globalClock;
+  while(t < until)
+    t = nextBankSlot(addr, false);
 }
 
 Time_t PortManagerBanked::reqDone(MemRequest *mreq, bool retrying) {
@@ -198,8 +199,8 @@ void PortManagerBanked::reqRetire(MemRequest *mreq) {
   GI(curPrefetch, maxPrefetch); // curPrefech == 0 unless maxPrefetch
 
   while(!overflow.empty()) {
-    MemRequest *oreq = overflow.back();
-    overflow.pop_back();
+    MemRequest *oreq = overflow.top();
+    overflow.pop();
     req2(oreq);
     if(curRequests >= maxRequests)
       break;
@@ -228,23 +229,23 @@ void PortManagerBanked::req2(MemRequest *mreq) {
   if(mreq->isWarmup())
     mreq->redoReq();
   else if(mreq->isNonCacheable())
-    mreq->redoReqAbs(globalClock + ncDelay);
+    batch.redoReqAbs(mreq, globalClock + ncDelay);
   else if(dupPrefetchTag && mreq->isPrefetch())
-    mreq->redoReqAbs(globalClock + tagDelay);
+    batch.redoReqAbs(mreq, globalClock + tagDelay);
   else
-    mreq->redoReqAbs(nextBankSlot(mreq->getAddr(), mreq->getStatsFlag()) + tagDelay);
+    batch.redoReqAbs(mreq, nextBankSlot(mreq->getAddr(), mreq->getStatsFlag()) + tagDelay);
 }
 void PortManagerBanked::req(MemRequest *mreq)
 /* main processor read entry point {{{1 */
 {
   if(!mreq->isRetrying() && !mreq->isPrefetch()) {
     if(curRequests >= maxRequests) {
-      overflow.push_front(mreq);
+      addOverflow(mreq);
       return;
     }
     while(!overflow.empty()) {
-      MemRequest *oreq = overflow.back();
-      overflow.pop_back();
+      MemRequest *oreq = overflow.top();
+      overflow.pop();
       req2(oreq);
       if(curRequests >= maxRequests)
         break;
@@ -252,7 +253,7 @@ void PortManagerBanked::req(MemRequest *mreq)
         break;
     }
     if(!overflow.empty()) {
-      overflow.push_front(mreq);
+      addOverflow(mreq);
       return;
     }
   }
@@ -325,21 +326,21 @@ void PortManagerBanked::reqAck(MemRequest *mreq)
 
   blockTime = until;
 
-  mreq->redoReqAckAbs(until);
+  batch.redoReqAckAbs(mreq, until);
 }
 // }}}
 
 void PortManagerBanked::setState(MemRequest *mreq)
 /* set state {{{1 */
 {
-  mreq->redoSetStateAbs(globalClock + 1);
+  batch.redoSetStateAbs(mreq, globalClock + 1);
 }
 // }}}
 
 void PortManagerBanked::setStateAck(MemRequest *mreq)
 /* set state ack {{{1 */
 {
-  mreq->redoSetStateAckAbs(globalClock + 1);
+  batch.redoSetStateAckAbs(mreq, globalClock + 1);
 }
 // }}}
 
@@ -348,6 +349,6 @@ void PortManagerBanked::disp(MemRequest *mreq)
 {
   Time_t t  = snoopFillBankUse(mreq);
   blockTime = t;
-  mreq->redoDispAbs(t);
+  batch.redoDispAbs(mreq, t);
 }
 // }}}
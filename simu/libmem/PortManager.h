@@ -1,6 +1,7 @@
 #ifndef PORTMANAGER_H
 #define PORTMANAGER_H
 
+#include "FastQueue.h"
 #include "MemRequest.h"
 #include "Port.h"
 
@@ -43,8 +44,14 @@ public:
 class PortManagerBanked : public PortManager {
 private:
 protected:
-  PortGeneric **bkPort;
-  PortGeneric * sendFillPort;
+  // Bank calendar: bkPortBusy[bank*bkNumPorts+i] is the cycle when port i
+  // of the bank is free. Same timing as a PortGeneric per bank (PortNPipe
+  // covers the pipelined cases) without the virtual call per access.
+  Time_t *     bkPortBusy;
+  int32_t      bkNumPorts;
+  TimeDelta_t  bkPortOccp; // 0 == unlimited
+  GStatsAvg ** bkAvgTime;
+  PortGeneric *sendFillPort;
 
   bool    dupPrefetchTag;
   bool    dropPrefetchFill;
@@ -71,14 +78,54 @@ protected:
 
   Time_t blockTime;
 
-  std::list<MemRequest *> overflow;
+  FastQueue<MemRequest *> overflow; // FIFO, grows when full
+
+  MemRequestBatch batch;
 
   Time_t snoopFillBankUse(MemRequest *mreq);
 
-  Time_t calcNextBankSlot(AddrType addr);
-  Time_t nextBankSlot(AddrType addr, bool en);
-  void   nextBankSlotUntil(AddrType addr, Time_t until, bool en);
-  void   req2(MemRequest *mreq);
+  Time_t calcNextBankSlot(AddrType addr) const {
+    if(bkPortOccp == 0)
+      return globalClock;
+
+    const Time_t *busy = &bkPortBusy[((addr >> bankShift) & numBanksMask) * bkNumPorts];
+
+    Time_t t = busy[0];
+    for(int32_t i = 1; i < bkNumPorts; i++) {
+      if(busy[i] < t)
+        t = busy[i];
+    }
+    return t < globalClock ? globalClock : t;
+  }
+
+  Time_t nextBankSlot(AddrType addr, bool en) {
+    uint32_t bank = (addr >> bankShift) & numBanksMask;
+    if(bkPortOccp == 0) {
+      bkAvgTime[bank]->sample(0, en);
+      return globalClock;
+    }
+
+    Time_t *busy = &bkPortBusy[bank * bkNumPorts];
+
+    int32_t p = 0;
+    for(int32_t i = 1; i < bkNumPorts; i++) {
+      if(busy[i] < busy[p])
+        p = i;
+    }
+    Time_t t = busy[p] < globalClock ? globalClock : busy[p];
+    busy[p]  = t + bkPortOccp;
+
+    bkAvgTime[bank]->sample(t - globalClock, en);
+    return t;
+  }
+
+  void nextBankSlotUntil(AddrType addr, Time_t until, bool en);
+  void addOverflow(MemRequest *mreq) {
+    if(overflow.full())
+      overflow.grow();
+    overflow.push(mreq);
+  }
+  void req2(MemRequest *mreq);
 
 public:
   PortManagerBanked(const char *section, MemObj *_mobj);
@@ -137,3 +137,10 @@ TimeDelta_t UnMemXBar::ffwrite(AddrType addr)
   return router->ffwrite(addr);
 }
 /* }}} */
+
+void UnMemXBar::ffbatch(const MemWarmupOp *ops, size_t n)
+/* fast forward batch {{{1 */
+{
+  router->ffbatch(ops, n);
+}
+/* }}} */
@@ -30,6 +30,21 @@ ProtocolBase::ProtocolBase(InterConnection *net, RouterID_t rID, PortID_t pID)
   //    myID, this, network);
 }
 
+ProtocolBase::~ProtocolBase() {
+  NetDevType::iterator it = netDev.find(network);
+  I(it != netDev.end());
+
+  // Keep the ids of the other devices, drop the list with the last one
+  DevList *devList = it->second;
+  (*devList)[myID] = 0;
+  for(size_t i = 0; i < devList->size(); i++) {
+    if((*devList)[i])
+      return;
+  }
+  delete devList;
+  netDev.erase(it);
+}
+
 void ProtocolBase::registerHandler(ProtocolCBBase *pcb, MessageType msgType) {
   network->registerProtocol(pcb, msgType, routerID, portID, myID);
 }
@@ -29,6 +29,7 @@ protected:
   // Map a device to a local device. Unless the portID is specified,
   // it can use any of the local ports.
   ProtocolBase(InterConnection *net, RouterID_t rID, PortID_t pID = LOCAL_PORT1);
+  virtual ~ProtocolBase();
 
   void registerHandler(ProtocolCBBase *pcb, MessageType msgType);
 
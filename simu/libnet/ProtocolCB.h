@@ -11,6 +11,8 @@ class Message;
 class ProtocolCBBase {
 protected:
 public:
+  virtual ~ProtocolCBBase() {
+  }
   virtual void call(Message *msg) = 0;
 };
 
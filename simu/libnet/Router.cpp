@@ -42,17 +42,17 @@ Router::Router(const char *section, RouterID_t id, InterConnection *n, RoutingTa
 
   for(PortID_t i = LOCAL_PORT1; i < maxLocalPort; i++) {
     char    name[256];
-    int32_t ret = snprintf(name, 127, "l2rPort(%d-%d)", myID, i);
+    int32_t ret = snprintf(name, sizeof(name), "%s_l2rPort(%d-%d)", section, myID, i);
     I(ret > 0);
     l2rPort[i] = PortGeneric::create(name, localPort, localOcc);
 
-    ret = snprintf(name, 127, "r2lPort(%d-%d)", myID, i);
+    ret = snprintf(name, sizeof(name), "%s_r2lPort(%d-%d)", section, myID, i);
     I(ret > 0);
     r2lPort[i] = PortGeneric::create(name, localPort, localOcc);
   }
   for(PortID_t i = DISABLED_PORT; i < rTable->getnPorts(); i++) {
     char    name[256];
-    int32_t ret = snprintf(name, 127, "r2rPort(%d-%d)", myID, i + 1);
+    int32_t ret = snprintf(name, sizeof(name), "%s_r2rPort(%d-%d)", section, myID, i + 1);
     I(ret > 0);
 
     r2rPort[i + 1] = PortGeneric::create(name, 1, 1);
@@ -110,21 +110,19 @@ void Router::launchMsg(Message *msg) {
 
   } else {
 
-    // JUDITH commented this out because
-    // occupySlots not defined anywhere in esesc
-    //    Time_t when = l2rPort[portid]->occupySlots(calcNumFlits(msg)); //original code
-    Time_t when = l2rPort[portid]->nextSlot(true);
-    for(int i = 0; i < calcNumFlits(msg); i++) {
-      l2rPort[portid]->nextSlot(true);
-    }
-    //   printf("%d\n", when);
+    // One slot for the header plus one per flit
+    Time_t when = l2rPort[portid]->nextSlots(calcNumFlits(msg) + 1, true);
 
     when += addFixDelay;
 
-    if(congestionFree)
+    if(congestionFree) {
+      // Compiled tables know the path latency, skip the hops analytically
+      if(rTable->isCompiled())
+        when += rTable->getPathLat(msg->getDstRouterID());
       msg->receiveMsgAbs(when, dstRouter);
-    else
+    } else {
       msg->forwardMsgAbs(when, this);
+    }
   }
 }
 
@@ -167,13 +165,7 @@ void Router::forwardMsg(Message *msg) {
     wire = 0;
   }
 
-  //  JUDITH commented this out because
-  //  occupySlots not defined anywhere in esesc
-  //  Time_t when = r2rPort[wire->port]->occupySlots(calcNumFlits(msg));
-  Time_t when = r2rPort[wire->port]->nextSlot(true);
-  for(int i = 0; i < calcNumFlits(msg); i++) {
-    r2rPort[wire->port]->nextSlot(true);
-  }
+  Time_t when = r2rPort[wire->port]->nextSlots(calcNumFlits(msg) + 1, true);
 
   // MSG("%lld router::forwardMsg %d->%d",globalClock,myID, wire->rID);
 
@@ -188,17 +180,11 @@ void Router::receiveMsg(Message *msg) {
   PortID_t portid = msg->getDstPortID();
   I(r2lPort[portid]);
 
-  //  JUDITH commented this out because
-  //  occupySlots not defined anywhere in esesc
-  //
-  //  Time_t when = r2lPort[portid]->occupySlots(calcNumFlits(msg));
-  Time_t when = r2lPort[portid]->nextSlot(true);
-  for(int i = 0; i < calcNumFlits(msg); i++) {
-    r2lPort[portid]->nextSlot(true);
-  }
+  unsigned short nFlits = calcNumFlits(msg);
+  Time_t         when   = r2lPort[portid]->nextSlots(nFlits + 1, true);
 
   // MSG("dstport:%d srcport:%d router:%d",portid,msg->getSrcPortID(),myID);
-  msg->notifyMsgAbs(when + calcNumFlits(msg), this);
+  msg->notifyMsgAbs(when + nFlits, this);
 }
 
 void Router::notifyMsg(Message *msg) {
@@ -218,11 +204,12 @@ void Router::notifyMsg(Message *msg) {
   // notify the network that it does not want a message. (Too many
   // freaking details, sorry)
 
-  ProtHandlersType::iterator it = localPortProtocol.find(msg->getUniqueProtID());
-  GLOG(it == localPortProtocol.end(), "Router[%d]::receiveMsg no one accepts packet in router[%d:%d] (uniqueID=%d)\n", myID,
-       msg->getDstRouterID(), msg->getDstPortID(), msg->getUniqueProtID());
+  size_t slot = protSlot(msg->getUniqueProtID());
+  GLOG(slot >= localPortProtocol.size() || localPortProtocol[slot] == 0,
+       "Router[%d]::receiveMsg no one accepts packet in router[%d:%d] (uniqueID=%d)\n", myID, msg->getDstRouterID(),
+       msg->getDstPortID(), msg->getUniqueProtID());
 
-  it->second->call(msg);
+  localPortProtocol[slot]->call(msg);
 
   // TODO: decrease destroy. (GC destroy)
 }
@@ -231,9 +218,22 @@ void Router::dump() {
   fprintf(stderr, "Router #%d\n", myID);
 }
 
+size_t Router::protSlot(int32_t uniqueProtID) {
+  // uniqueProtID is (NetDevice_t << 16) ^ MessageType (see PMessage::getUniqueProtID)
+  size_t dev  = static_cast<uint32_t>(uniqueProtID) >> 16;
+  size_t type = uniqueProtID & 0xFFFF;
+  I(type < MaxMessageType);
+
+  return dev * MaxMessageType + type;
+}
+
 void Router::registerProtocol(ProtocolCBBase *pcb, PortID_t pID, int32_t id) {
-  I(localPortProtocol.find(id) == localPortProtocol.end());
-  localPortProtocol[id] = pcb;
+  size_t slot = protSlot(id);
+  if(slot >= localPortProtocol.size())
+    localPortProtocol.resize(slot + 1, 0);
+
+  I(localPortProtocol[slot] == 0);
+  localPortProtocol[slot] = pcb;
 }
 
 unsigned short Router::calcNumFlits(Message *msg) const {
@@ -51,7 +51,8 @@ private:
 
   RoutingTable *rTable;
 
-  typedef HASH_MAP<int32_t, ProtocolCBBase *> ProtHandlersType;
+  // Direct indexed by protSlot(uniqueProtID)
+  typedef std::vector<ProtocolCBBase *> ProtHandlersType;
 
   ProtHandlersType localPortProtocol;
 
@@ -61,6 +62,7 @@ private:
 
 protected:
   unsigned short calcNumFlits(Message *msg) const;
+  static size_t  protSlot(int32_t uniqueProtID);
 
 public:
   Router(const char *section, RouterID_t id, InterConnection *n, RoutingTable *rt);
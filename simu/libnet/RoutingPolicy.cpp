@@ -47,6 +47,9 @@ void RoutingPolicy::make(const char *section) {
     if(next[i])
       table[i]->setNextWire(next[i]);
   }
+
+  if(SescConf->checkBool(section, "compiledRouting") && SescConf->getBool(section, "compiledRouting"))
+    compile();
 #ifdef DEBUG
   // dump();
 #endif
@@ -124,6 +127,31 @@ void RoutingPolicy::shortestPaths(RouterID_t dest) {
   } while(k != -1);
 }
 
+// Flatten the per router next hop lists into one dense table. Only the
+// first path is kept (like fixMessagePath), so getWire becomes an index.
+void RoutingPolicy::compile() {
+  hopTable.assign(nRouters * nRouters, RoutingTable::Wire(0, DISABLED_PORT, 0));
+  latTable.assign(nRouters * nRouters, 0);
+
+  for(RouterID_t i = 0; i < nRouters; i++) {
+    for(RouterID_t j = 0; j < nRouters; j++) {
+      size_t pos = i * nRouters + j;
+      if(i == j) {
+        hopTable[pos] = RoutingTable::Wire(i, LOCAL_PORT1, 0);
+        continue;
+      }
+      const RoutingTable::Wire *w = table[i]->getFirstWire(j);
+      if(w == 0)
+        continue; // Unreachable
+      hopTable[pos] = *w;
+      latTable[pos] = adjacent[i][j][0].dist;
+    }
+  }
+
+  for(RouterID_t i = 0; i < nRouters; i++)
+    table[i]->setCompiled(&hopTable[i * nRouters], &latTable[i * nRouters]);
+}
+
 void RoutingPolicy::dump() const {
   for(size_t i = 0; i < nRouters; i++) {
     char chain[256];
@@ -150,7 +178,7 @@ void RoutingPolicy::dump() const {
 
 void FullyConnectedRoutingPolicy::create() {
   for(size_t i = 0; i < nRouters; i++) {
-    PortID_t last = PortID_t(0);
+    PortID_t last = UP_PORT; // r2rPort and shortestPaths start at UP_PORT
     for(size_t j = 0; j < nRouters; j++) {
       if(i != j) {
         adjacent[i][j][0].rID  = j;
@@ -30,7 +30,12 @@ protected:
   std::vector<std::vector<std::vector<MyWire>>> adjacent;
   std::vector<MyWire *>                         next;
 
+  // Compiled routing: dense tables indexed by [router*nRouters + dest]
+  std::vector<RoutingTable::Wire> hopTable;
+  std::vector<TimeDelta_t>        latTable;
+
   void shortestPaths(RouterID_t dst);
+  void compile();
 
   RoutingPolicy(const char *section, size_t ports);
 
@@ -16,7 +16,9 @@ void RoutingTable::Wire::dump(const char *str) const {
 RoutingTable::RoutingTable(const char *section, RouterID_t id, size_t size, PortID_t np)
     : myID(id)
     , fixMessagePath(SescConf->getBool(section, "fixMessagePath"))
-    , nPorts(np) {
+    , nPorts(np)
+    , compiledHop(0)
+    , compiledLat(0) {
   SescConf->isBool(section, "fixMessagePath");
 
   nextHop.resize(size);
@@ -58,7 +60,7 @@ void RoutingTable::addNeighborWire(RouterID_t id, const Wire &wire) {
   nextHop[id].succs.push_back(wire);
 }
 
-const RoutingTable::Wire *RoutingTable::getWire(RouterID_t destid) {
+const RoutingTable::Wire *RoutingTable::getMultiPathWire(RouterID_t destid) {
   size_t pos = nextHop[destid].prevTurn + 1;
   I(!nextHop[destid].succs.empty());
 
@@ -45,13 +45,42 @@ protected:
   std::vector<Wires4Router> nextHop;
   Wire *                    next; /* next in broadcast (see Message::Type or ask Karin) */
 
+  // Compiled routing: this router row of the dense RoutingPolicy tables
+  const Wire *       compiledHop;
+  const TimeDelta_t *compiledLat;
+
   const Wire *getPortWire(RouterID_t id, PortID_t port) const;
+  const Wire *getMultiPathWire(RouterID_t destid);
 
 public:
   RoutingTable(const char *section, RouterID_t id, size_t size, PortID_t np);
   virtual ~RoutingTable();
 
-  const Wire *getWire(RouterID_t destid);
+  const Wire *getWire(RouterID_t destid) {
+    if(compiledHop)
+      return &compiledHop[destid];
+    return getMultiPathWire(destid);
+  }
+
+  // First wire selected for destid (0 if unreachable)
+  const Wire *getFirstWire(RouterID_t destid) const {
+    if(nextHop[destid].succs.empty())
+      return 0;
+    return &nextHop[destid].succs[0];
+  }
+
+  void setCompiled(const Wire *hop, const TimeDelta_t *lat) {
+    compiledHop = hop;
+    compiledLat = lat;
+  }
+  bool isCompiled() const {
+    return compiledHop != 0;
+  }
+  // Contention free latency to destid (only with compiled routing)
+  TimeDelta_t getPathLat(RouterID_t destid) const {
+    I(compiledLat);
+    return compiledLat[destid];
+  }
 
   void setNextWire(Wire *w) {
     next = w;
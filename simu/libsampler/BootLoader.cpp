@@ -55,6 +55,7 @@
 #include "OoOProcessor.h"
 
 #include "DrawArch.h"
+#include "HostProfiler.h"
 #include "Report.h"
 #include "SescConf.h"
 
@@ -162,6 +163,7 @@ void BootLoader::report(const char *str) {
   TaskHandler::report(str);
 
   Report::field("OSSim:msecs=%8.2f", (double)msecs / 1000);
+  HostProfiler::report();
 
   GStats::report(str);
 
@@ -363,6 +365,9 @@ void BootLoader::plug(int argc, const char **argv) {
     MSG("Power calculations disabled");
   }
 
+  if(SescConf->checkBool("", "hostProfile") && SescConf->getBool("", "hostProfile"))
+    HostProfiler::enable();
+
   check();
   TaskHandler::plugEnd();
 }
@@ -0,0 +1,184 @@
+// The ESESC/BSD License
+//
+// Copyright (c) 2005-2013, Regents of the University of California and
+// the ESESC Project.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   - Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+//   - Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in the
+//   documentation and/or other materials provided with the distribution.
+//
+//   - Neither the name of the University of California, Santa Cruz nor the
+//   names of its contributors may be used to endorse or promote products
+//   derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <math.h>
+#include <string.h>
+
+#include <algorithm>
+
+#include "PhaseDetector.h"
+#include "SescConf.h"
+
+PhaseDetector::PhaseDetector(const char *section, FlowID fid)
+    /* constructor {{{1 */
+    : bbvSize(SescConf->checkInt(section, "phaseBBVSize") ? SescConf->getInt(section, "phaseBBVSize") : 32)
+    , threshold(SescConf->checkDouble(section, "phaseThreshold") ? SescConf->getDouble(section, "phaseThreshold") : 0.2)
+    , minSamples(SescConf->checkInt(section, "phaseMinSamples") ? SescConf->getInt(section, "phaseMinSamples") : 2)
+    , maxError(SescConf->checkDouble(section, "phaseMaxError") ? SescConf->getDouble(section, "phaseMaxError") : 0.05)
+    , revalidate(SescConf->checkInt(section, "phaseRevalidate") ? SescConf->getInt(section, "phaseRevalidate") : 8)
+    , maxPhases(SescConf->checkInt(section, "phaseMax") ? SescConf->getInt(section, "phaseMax") : 64) {
+
+  if(bbvSize < 4 || minSamples < 1 || revalidate < 1 || maxPhases < 1 || threshold <= 0 || maxError <= 0) {
+    MSG("ERROR: section [%s] has an invalid phase detector configuration", section);
+    SescConf->notCorrect();
+  }
+
+  bbv.resize(bbvSize);
+  signature.resize(bbvSize);
+  clear();
+  nIntervals = 0;
+
+  nNew          = new GStatsCntr("S(%u):phaseNew", fid);
+  nHit          = new GStatsCntr("S(%u):phaseHit", fid);
+  nReuse        = new GStatsCntr("S(%u):phaseReuse", fid);
+  nValidate     = new GStatsCntr("S(%u):phaseValidate", fid);
+  nValidateFail = new GStatsCntr("S(%u):phaseValidateFail", fid);
+}
+/* }}} */
+
+void PhaseDetector::clear() {
+  std::fill(bbv.begin(), bbv.end(), 0);
+  blockInst = 0;
+}
+
+int32_t PhaseDetector::classify()
+/* find the closest phase for the sampled bbv {{{1 */
+{
+  nIntervals++;
+
+  uint64_t total = 0;
+  for(size_t i = 0; i < bbvSize; i++)
+    total += bbv[i];
+
+  if(total == 0) {
+    std::fill(signature.begin(), signature.end(), 0);
+    clear();
+    return -1;
+  }
+
+  for(size_t i = 0; i < bbvSize; i++)
+    signature[i] = static_cast<float>(bbv[i]) / total;
+  clear();
+
+  // Manhattan distance between normalized vectors (0 same, 2 disjoint)
+  int32_t best     = -1;
+  double  bestDist = threshold;
+  for(size_t p = 0; p < phases.size(); p++) {
+    double dist = 0;
+    for(size_t i = 0; i < bbvSize; i++)
+      dist += fabs(phases[p].centroid[i] - signature[i]);
+
+    if(dist < bestDist) {
+      bestDist = dist;
+      best     = p;
+    }
+  }
+
+  if(best >= 0) {
+    nHit->inc();
+    phases[best].lastUsed = nIntervals;
+  }
+
+  return best;
+}
+/* }}} */
+
+bool PhaseDetector::canReuse(int32_t id)
+/* enough confidence to skip the timing interval {{{1 */
+{
+  if(id < 0)
+    return false;
+
+  Phase &ph = phases[id];
+  if(ph.nSamples < minSamples)
+    return false;
+
+  if(ph.nReused >= revalidate) {
+    nValidate->inc();
+    return false;
+  }
+
+  ph.nReused++;
+  nReuse->inc();
+
+  return true;
+}
+/* }}} */
+
+void PhaseDetector::update(int32_t id, double cpi)
+/* a timing interval finished {{{1 */
+{
+  if(id < 0) {
+    // Unknown behavior, start a new phase (replacing the least recently used)
+    size_t p = phases.size();
+    if(p >= maxPhases) {
+      p = 0;
+      for(size_t i = 1; i < phases.size(); i++) {
+        if(phases[i].lastUsed < phases[p].lastUsed)
+          p = i;
+      }
+    } else {
+      phases.resize(p + 1);
+    }
+
+    Phase &ph   = phases[p];
+    ph.centroid = signature;
+    ph.cpi      = cpi;
+    ph.nSamples = 1;
+    ph.nReused  = 0;
+    ph.lastUsed = nIntervals;
+
+    nNew->inc();
+    return;
+  }
+
+  Phase &ph = phases[id];
+
+  double err = fabs(cpi - ph.cpi) / ph.cpi;
+  if(err > maxError) {
+    // Out of the error bound, the phase has to be learned again
+    if(ph.nSamples >= minSamples)
+      nValidateFail->inc();
+    ph.cpi      = cpi;
+    ph.nSamples = 1;
+  } else {
+    ph.nSamples++;
+    ph.cpi += (cpi - ph.cpi) / ph.nSamples;
+  }
+  ph.nReused = 0;
+
+  // Move the centroid towards the new interval
+  float w = 1.0f / (ph.nSamples < 16 ? ph.nSamples + 1 : 16);
+  for(size_t i = 0; i < bbvSize; i++)
+    ph.centroid[i] += (signature[i] - ph.centroid[i]) * w;
+}
+/* }}} */
@@ -0,0 +1,121 @@
+// The ESESC/BSD License
+//
+// Copyright (c) 2005-2013, Regents of the University of California and
+// the ESESC Project.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   - Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+//
+//   - Redistributions in binary form must reproduce the above copyright
+//   notice, this list of conditions and the following disclaimer in the
+//   documentation and/or other materials provided with the distribution.
+//
+//   - Neither the name of the University of California, Santa Cruz nor the
+//   names of its contributors may be used to endorse or promote products
+//   derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef PHASEDETECTOR_H
+#define PHASEDETECTOR_H
+
+#include <stdint.h>
+
+#include <vector>
+
+#include "GStats.h"
+#include "InstOpcode.h"
+#include "RAWDInst.h"
+
+/*
+ * Online phase classification for the periodic sampler.
+ *
+ * The instructions streamed before each timing interval (warmup and detail)
+ * are summarized in a basic block vector: every control instruction adds
+ * the size of the block it closes to a bucket selected by its PC (a random
+ * projection of the BBV, as in SimPoint). Each timing
+ * interval is assigned to the nearest known phase (or starts a new one) and
+ * refines the phase CPI. Once a phase has phaseMinSamples measurements whose
+ * CPI stays within phaseMaxError, the sampler skips the timing interval and
+ * reuses the phase CPI. Every phaseRevalidate reuses the interval is timed
+ * again; if the error bound is exceeded the phase loses its confidence.
+ */
+
+class PhaseDetector {
+private:
+  class Phase {
+  public:
+    std::vector<float> centroid;
+    double             cpi;       // Running mean of the measured CPI
+    uint32_t           nSamples;  // Timing intervals that agreed with cpi
+    uint32_t           nReused;   // Reuses since the last validation
+    uint64_t           lastUsed;
+  };
+
+  const size_t   bbvSize;
+  const double   threshold;
+  const uint32_t minSamples;
+  const double   maxError;
+  const uint32_t revalidate;
+  const size_t   maxPhases;
+
+  std::vector<uint64_t> bbv;
+  uint64_t              blockInst; // Instructions since the last control instruction
+  uint64_t              nIntervals;
+
+  std::vector<float> signature; // Normalized bbv of the last classify
+  std::vector<Phase> phases;
+
+  GStatsCntr *nNew;
+  GStatsCntr *nHit;
+  GStatsCntr *nReuse;
+  GStatsCntr *nValidate;
+  GStatsCntr *nValidateFail;
+
+  static bool isControl(char op) {
+    return op >= iBALU_LBRANCH && op <= iBALU_RET;
+  }
+
+public:
+  PhaseDetector(const char *section, FlowID fid);
+
+  void sample(uint64_t pc, char op) {
+    blockInst++;
+    if(!isControl(op))
+      return;
+
+    uint64_t h = (pc >> 2) * 0x9E3779B97F4A7C15ULL;
+    bbv[(h >> 32) % bbvSize] += blockInst;
+    blockInst = 0;
+  }
+
+  void clear();
+
+  // Phase of the instructions sampled since the last clear (-1 if unknown).
+  // It also clears the sampled vector.
+  int32_t classify();
+
+  bool   canReuse(int32_t id);
+  double getCPI(int32_t id) const {
+    return phases[id].cpi;
+  }
+
+  // A timing interval classified as id (or -1) measured cpi
+  void update(int32_t id, double cpi);
+};
+
+#endif
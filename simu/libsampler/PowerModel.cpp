@@ -38,6 +38,7 @@
 #include "Bundle.h"
 #include "GMemorySystem.h"
 #include "GProcessor.h"
+#include "HostProfiler.h"
 #include "MemObj.h"
 #include "PowerStats.h"
 #include "Report.h"
@@ -224,6 +225,8 @@ void PowerModel::printStatus()
 void PowerModel::calcStats(uint64_t timeinterval, bool keepPower, FlowID fid)
 /* calcStats {{{1 */
 {
+  HostProfScope prof(HostProfiler::Power);
+
   // This is called through sampler. So the power/thermal
   // simulator are called explicitly rather than periodically by
   // a timer.
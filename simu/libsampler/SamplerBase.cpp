@@ -42,6 +42,10 @@
 #include "Report.h"
 #include "SescConf.h"
 
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
 #include <iostream>
 
 uint64_t SamplerBase::lastTime           = 0;
@@ -125,6 +129,41 @@ SamplerBase::SamplerBase(const char *iname, const char *section, EmulInterface *
   cpiHistSize = static_cast<uint32_t>(SescConf->getDouble(section, "PowPredictionHist"));
   cpiHist.resize(cpiHistSize);
 
+  reuseClock = 0;
+  reuseInst  = 0;
+
+  maxForkChildren = SescConf->checkInt(section, "forkSamples") ? SescConf->getInt(section, "forkSamples") : 0;
+  if(maxForkChildren > 0 && (emu->getNumEmuls() > 1 || emu->getNumFlows() > 1)) {
+    // fork() keeps only the calling thread, the other cores' emulation
+    // threads would be gone in the child
+    MSG("WARNING: sampler [%s] forkSamples needs a single emulated core, running the samples serially", section);
+    maxForkChildren = 0;
+  }
+  if(maxForkChildren > 0) {
+    forkSampling = true; // QEMUReader::start checks it
+    TaskHandler::enableForkSamples();
+  }
+  nForkChildren   = 0;
+  nForkSamples    = 0;
+  forkChild       = false;
+  forkBaseInst    = 0;
+  forkBaseClock   = 0;
+  forkSamples     = 0;
+  forkInst        = 0;
+  forkClock       = 0;
+  if(maxForkChildren > 0) {
+    if(pipe(forkPipe) != 0) {
+      MSG("ERROR: sampler [%s] could not create the forkSamples pipe", section);
+      exit(-1);
+    }
+    // Children may die without writing, never block on the read side
+    fcntl(forkPipe[0], F_SETFL, O_NONBLOCK);
+
+    forkSamples = new GStatsCntr("S(%d):forkSamples", fid);
+    forkInst    = new GStatsCntr("S(%d):forkTimingInst", fid);
+    forkClock   = new GStatsCntr("S(%d):forkTimingClock", fid);
+  }
+
   first = true;
   for(unsigned int i = 0; i < cpiHistSize; i++)
     cpiHist.push_back(1.0);
@@ -136,6 +175,12 @@ SamplerBase::SamplerBase(const char *iname, const char *section, EmulInterface *
   MemObj *    mobj  = gproc->getMemorySystem()->getDL1();
   DL1               = mobj;
 
+  // Batched cache warmup with the accesses seen in EmuWarmup mode
+  warmupBatchSize = 0;
+  if(SescConf->checkInt(section, "warmupBatch"))
+    warmupBatchSize = SescConf->getInt(section, "warmupBatch");
+  warmupBatch.reserve(warmupBatchSize);
+
   double ninst_d = SescConf->getDouble(section, "nInstDetail");
   double ninst_t = SescConf->getDouble(section, "nInstTiming");
   double ninst_r = SescConf->getDouble(section, "nInstRabbit");
@@ -148,20 +193,35 @@ SamplerBase::SamplerBase(const char *iname, const char *section, EmulInterface *
 }
 /* }}} */
 
-void SamplerBase::doWarmupOpAddr(InstOpcode op, uint64_t addr) {
+void SamplerBase::doWarmupOpAddr(InstOpcode op, uint64_t addr, uint64_t pc) {
   // {{{1 update cache stats when in warmup mode
-  if(addr == 0)
+  if(addr == 0 || warmupBatchSize == 0)
     return;
 
   I(mode == EmuWarmup);
   I(emul->cputype != GPU);
 
-#if 0
-	if ( op == iLALU_LD)
-		DL1->ffread(addr);
-	else if (op == iSALU_ST)
-		DL1->ffwrite(addr);
-#endif
+  if(op != iLALU_LD && op != iSALU_ST)
+    return;
+
+  MemWarmupOp wop;
+  wop.addr  = addr;
+  wop.pc    = pc;
+  wop.write = (op == iSALU_ST);
+  warmupBatch.push_back(wop);
+
+  if(warmupBatch.size() >= warmupBatchSize)
+    flushWarmup();
+}
+// 1}}}
+
+void SamplerBase::flushWarmup() {
+  // {{{1 send the pending warmup accesses down the memory hierarchy
+  if(warmupBatch.empty())
+    return;
+
+  DL1->ffbatch(&warmupBatch[0], warmupBatch.size());
+  warmupBatch.clear();
 }
 // 1}}}
 
@@ -208,7 +268,7 @@ uint64_t SamplerBase::getTime()
   // I(phasenInst==0);
 
   // FIXME: try to use core stats nInst and clockTicks to get CPI
-  double cpi2    = globalClock_Timing->getDouble() / (1 + iusage[EmuTiming]->getDouble());
+  double cpi2    = (globalClock_Timing->getDouble() + reuseClock) / (1 + iusage[EmuTiming]->getDouble() + reuseInst);
   double addtime = cpi2 * totalnInst;
   addtime        = addtime * (1e9 / getFreq());
 
@@ -243,6 +303,9 @@ FlowID SamplerBase::resumeThread(FlowID uid) {
 }
 
 void SamplerBase::terminate() {
+  if(isForkParent())
+    forkMerge(); // The program finished before nInstMax/maxnsTime
+
   terminated = true;
   progressedTime->sample(getTime(), true);
   TaskHandler::terminate();
@@ -299,6 +362,140 @@ FILE *SamplerBase::genReportFileNameAndOpen(const char *str) {
   return fp;
 }
 
+// Result of one forked sample, sent through forkPipe (smaller than PIPE_BUF,
+// so the writes of several children do not interleave)
+struct ForkSampleRecord {
+  uint32_t id;
+  uint64_t nInst;
+  uint64_t nClock;
+};
+
+static void *forkSimuThread(void *) {
+  TaskHandler::boot();
+  return 0;
+}
+
+static pthread_t forkSimuThreadID;
+
+bool SamplerBase::forkSample(FlowID fid)
+/* fork a child for the next sample, returns true if this process runs it {{{1 */
+{
+  forkCollect(false);
+  while(nForkChildren >= maxForkChildren)
+    forkCollect(true);
+
+  // Only the calling (emulation) thread survives in the child. The
+  // simulation thread is idle in the parent (it never leaves rabbit mode),
+  // so the child just starts a new one on the same state.
+  fflush(0);
+  pid_t pid = fork();
+  if(pid < 0) {
+    MSG("WARNING: forkSamples could not fork, running sample %u serially", nForkSamples);
+    return true;
+  }
+
+  if(pid == 0) {
+    forkChild = true;
+    close(forkPipe[0]);
+
+    forkBaseInst  = iusage[EmuTiming]->getDouble();
+    forkBaseClock = globalClock_Timing->getDouble();
+    GStats::forkSnapshot();
+
+    pthread_create(&forkSimuThreadID, 0, forkSimuThread, 0);
+    return true;
+  }
+
+  nForkChildren++;
+  nForkSamples++;
+  return false;
+}
+/* }}} */
+
+void SamplerBase::forkSampleDone()
+/* child: send the sample to the parent, write a partial report, and exit {{{1 */
+{
+  I(forkChild);
+
+  TaskHandler::stopBoot();
+  pthread_join(forkSimuThreadID, 0);
+
+  ForkSampleRecord r;
+  r.id     = nForkSamples;
+  r.nInst  = static_cast<uint64_t>(iusage[EmuTiming]->getDouble() - forkBaseInst);
+  r.nClock = static_cast<uint64_t>(globalClock_Timing->getDouble() - forkBaseClock);
+  if(write(forkPipe[1], &r, sizeof(r)) != sizeof(r))
+    MSG("WARNING: forkSamples sample %u could not reach the parent", r.id);
+
+  char name[1024];
+  snprintf(name, sizeof(name), "%s.s%u.gstats", Report::getNameID(), r.id);
+  if(!GStats::forkDump(name))
+    MSG("WARNING: forkSamples sample %u could not write %s", r.id, name);
+
+  snprintf(name, sizeof(name), "%s.s%u", Report::getNameID(), r.id);
+  BootLoader::reportOnTheFly(name);
+
+  _exit(0);
+}
+/* }}} */
+
+void SamplerBase::forkCollect(bool wait)
+/* reap finished children and account their samples {{{1 */
+{
+  int status;
+  while(nForkChildren > 0) {
+    pid_t pid = waitpid(-1, &status, wait ? 0 : WNOHANG);
+    if(pid <= 0)
+      break;
+    nForkChildren--;
+    wait = false; // one is enough when blocking
+
+    if(!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+      MSG("WARNING: forkSamples child %d did not finish cleanly", (int)pid);
+  }
+
+  ForkSampleRecord r;
+  while(read(forkPipe[0], &r, sizeof(r)) == sizeof(r)) {
+    forkSamples->inc();
+    forkInst->add(r.nInst);
+    forkClock->add(r.nClock);
+
+    // The parent never times, the samples give its CPI
+    reuseInst += r.nInst;
+    reuseClock += r.nClock;
+    if(reuseInst)
+      estCPI = static_cast<double>(reuseClock) / reuseInst;
+  }
+}
+/* }}} */
+
+void SamplerBase::forkMerge()
+/* parent: wait for every sample and add their statistics to ours {{{1 */
+{
+  while(nForkChildren > 0)
+    forkCollect(true);
+  forkCollect(false);
+
+  // The samples were fast-forwarded here, so their instructions also stay
+  // in the rabbit counters
+  char name[1024];
+  for(uint32_t id = 0; id < nForkSamples; id++) {
+    snprintf(name, sizeof(name), "%s.s%u.gstats", Report::getNameID(), id);
+    if(!GStats::forkMerge(name)) {
+      MSG("WARNING: forkSamples sample %u has no statistics (%s)", id, name);
+      continue;
+    }
+    unlink(name);
+  }
+
+  double cpi = forkInst->getDouble() > 0 ? forkClock->getDouble() / forkInst->getDouble() : 0;
+  MSG("forkSamples: %u samples merged, CPI %g (partial reports %s.s*)", nForkSamples, cpi, Report::getNameID());
+  Report::field("OSSim:forkSamples=%u:forkCPI=%g", nForkSamples, cpi);
+
+  maxForkChildren = 0; // Merged once, no more samples forked
+}
+/* }}} */
+
 void SamplerBase::fetchNextMode() {
   if(roi_skip) {
     next_mode = EmuRabbit;
@@ -47,6 +47,7 @@
 #include "nanassert.h"
 
 class MemObj;
+struct MemWarmupOp;
 
 class SamplerBase : public EmuSampler {
 
@@ -54,6 +55,9 @@ private:
 protected:
   MemObj *DL1; // For warmup
 
+  size_t                   warmupBatchSize; // 0 disables the cache warmup
+  std::vector<MemWarmupOp> warmupBatch;
+
   uint64_t nInstRabbit;
   uint64_t nInstWarmup;
   uint64_t nInstDetail;
@@ -82,6 +86,8 @@ protected:
 
   double dt_ratio;
   double estCPI;
+  double reuseClock; // Cycles of the intervals not timed (phase reuse)
+  double reuseInst;
   double freq;
   bool   first;
 
@@ -93,12 +99,34 @@ protected:
   size_t             headPtr;
   std::vector<float> cpiHist;
 
+  // Fork based sampling (forkSamples > 0): each sample runs in a child
+  // process while the parent keeps fast-forwarding.
+  int32_t     maxForkChildren;
+  int32_t     nForkChildren;
+  uint32_t    nForkSamples;
+  bool        forkChild;
+  int         forkPipe[2];
+  double      forkBaseInst;
+  double      forkBaseClock;
+  GStatsCntr *forkSamples;
+  GStatsCntr *forkInst;
+  GStatsCntr *forkClock;
+
+  bool isForkParent() const {
+    return maxForkChildren > 0 && !forkChild;
+  }
+  bool forkSample(FlowID fid);
+  void forkSampleDone();
+  void forkCollect(bool wait);
+  void forkMerge();
+
   bool allDone();
   void markThisDone(FlowID fid);
 
   FILE *genReportFileNameAndOpen(const char *str);
   void  fetchNextMode();
-  void  doWarmupOpAddr(InstOpcode op, uint64_t addr);
+  void  doWarmupOpAddr(InstOpcode op, uint64_t addr, uint64_t pc = 0);
+  void  flushWarmup();
 
 public:
   SamplerBase(const char *name, const char *section, EmulInterface *emul, FlowID fid = 0);
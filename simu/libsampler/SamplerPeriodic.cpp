@@ -41,6 +41,7 @@
 #include "GMemorySystem.h"
 #include "GProcessor.h"
 #include "MemObj.h"
+#include "PhaseDetector.h"
 #include "SamplerPeriodic.h"
 #include "SescConf.h"
 #include "TaskHandler.h"
@@ -90,6 +91,17 @@ SamplerPeriodic::SamplerPeriodic(const char *iname, const char *section, EmulInt
   headPtr = 0;
 
   lastMode = EmuInit;
+
+  phase          = 0;
+  phaseID        = -1;
+  phaseReused    = false;
+  phaseStartInst = 0;
+  if(SescConf->checkBool(section, "phaseDetect") && SescConf->getBool(section, "phaseDetect")) {
+    if(SescConf->getRecordSize("", "cpuemul") > 1)
+      MSG("WARNING: sampler [%s] phaseDetect only works with a single emulated core, disabled", section);
+    else
+      phase = new PhaseDetector(section, fid);
+  }
 }
 /* }}} */
 
@@ -117,15 +129,20 @@ uint64_t SamplerPeriodic::queue(uint64_t pc, uint64_t addr, uint64_t data, FlowI
       execute(fid, rabbitInst);
       return rabbitInst;
     }
+    if(phase && mode != EmuTiming)
+      phase->sample(pc, op);
     if(mode == EmuDetail || mode == EmuTiming) {
       emul->queueInstruction(pc, addr, data, op, fid, src1, src2, dest, dest2, getStatsFlag(), data2);
       return 0;
     }
     I(mode == EmuWarmup);
-    doWarmupOpAddr(static_cast<InstOpcode>(op), addr);
+    doWarmupOpAddr(static_cast<InstOpcode>(op), addr, pc);
     return 0;
   }
 
+  if(mode == EmuWarmup)
+    flushWarmup();
+
 #if 0
   // We did enough
   if (mode == EmuTiming)
@@ -147,6 +164,9 @@ void SamplerPeriodic::updateCPI(FlowID fid)
   if(lastMode != EmuTiming)
     return;
 
+  if(phase)
+    phase->update(phaseID, getMeaCPI());
+
   updateCPIHist();
   loadPredCPI();
 }
@@ -322,10 +342,43 @@ void SamplerPeriodic::syncTimeAndSamples(FlowID fid) {
   }
 }
 
+void SamplerPeriodic::phaseNextMode()
+/* replace the timing interval by the CPI of a known phase {{{1 */
+{
+  if(phaseReused) {
+    // The interval just skipped runs at the phase CPI
+    double   cpi = phase->getCPI(phaseID);
+    uint64_t n   = totalnInst - phaseStartInst;
+    reuseInst += n;
+    reuseClock += n * cpi;
+
+    cpiHist[headPtr] = cpi;
+    computeEstCPI();
+    updateIntervalRatio();
+
+    phaseReused = false;
+  }
+
+  if(next_mode != EmuTiming)
+    return;
+
+  phaseID = phase->classify();
+  if(!phase->canReuse(phaseID))
+    return;
+
+  next_mode      = EmuRabbit;
+  phaseReused    = true;
+  phaseStartInst = totalnInst;
+}
+/* }}} */
+
 void SamplerPeriodic::coordinateWithOthersAndNextMode(FlowID fid) {
 
   fetchNextMode();
 
+  if(phase)
+    phaseNextMode();
+
   syncTimeAndSamples(fid);
 
   if(lastMode == EmuTiming) {
@@ -42,6 +42,8 @@
 #include "GStats.h"
 #include "SamplerBase.h"
 
+class PhaseDetector;
+
 class SamplerPeriodic : public SamplerBase {
 private:
 protected:
@@ -53,6 +55,11 @@ protected:
 
   GStatsCntr *dsync;
 
+  PhaseDetector *phase; // 0 unless phaseDetect
+  int32_t        phaseID;
+  bool           phaseReused;
+  uint64_t       phaseStartInst;
+
   static int32_t PerfSampleLeftForTemp;
 
   void coordinateWithOthersAndNextMode(FlowID fid);
@@ -62,6 +69,7 @@ protected:
   void syncTimeAndFinishWaitingForOthers(FlowID fid);
   void syncTimeAndSamples(FlowID fid);
   void nextMode(bool rotate, FlowID fid, EmuMode mod = EmuRabbit);
+  void phaseNextMode();
 
   void updateCPI(FlowID id);
   void updateCPIHist();
@@ -128,6 +128,19 @@ uint64_t SamplerSMARTS::queue(uint64_t pc, uint64_t addr, uint64_t data, FlowID
 
   lastMode = mode;
   nextMode(ROTATE, fid);
+
+  if(forkChild && lastMode == EmuTiming)
+    forkSampleDone(); // Does not return
+
+  if(isForkParent() && (getTime() >= maxnsTime || totalnInst >= nInstMax)) {
+    forkMerge();
+    markDone();
+    pthread_mutex_unlock(&mode_lock);
+    MSG("finishing QEMU thread");
+    pthread_exit(0);
+    return 0;
+  }
+
   if(lastMode == EmuTiming) { // timing is going to be over
 
 #if 0
@@ -183,6 +196,22 @@ void SamplerSMARTS::nextMode(bool rotate, FlowID fid, EmuMode mod) {
     fetchNextMode();
     I(next_mode != EmuInit);
 
+    if(isForkParent() && lastMode == EmuRabbit && next_mode != EmuRabbit && !forkSample(fid)) {
+      // A child runs the whole sample, keep fast-forwarding over it
+      uint64_t sampleInst = 0;
+      for(size_t i = 0; i < sequence_mode.size(); i++) {
+        if(sequence_mode[i] != EmuRabbit)
+          sampleInst += sequence_size[i];
+      }
+      sequence_pos = sequence_mode.size() - 1;
+      next_mode    = EmuRabbit;
+
+      setMode(next_mode, fid);
+      setModeNativeRabbit();
+      setNextSwitch(getNextSwitch() + sampleInst);
+      return;
+    }
+
     setMode(next_mode, fid);
 
     if(next_mode == EmuRabbit) {